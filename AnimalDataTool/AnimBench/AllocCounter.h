@@ -0,0 +1,11 @@
+﻿#pragma once
+#include <cstdint>
+
+// 全局 operator new/delete 的计数（AllocCounter.cpp 替换了全局分配函数，只链接进基准测试程序）
+struct AllocSnapshot
+{
+    uint64_t count;  // 分配次数
+    uint64_t bytes;  // 分配的字节数
+};
+
+AllocSnapshot alloc_snapshot();
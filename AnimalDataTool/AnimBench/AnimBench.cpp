@@ -0,0 +1,356 @@
+﻿// 分类器微基准：生成合成的 depot 路径语料，逐个测量分类函数、完整 classifyRow 和 CSV 读写函数的
+// 吞吐（行/秒、纳秒/行）与每行的内存分配次数/字节数。结果可输出为 JSON，用于在不同提交之间比较。
+//
+// 用法：AnimBench [--rows=200000] [--seed=2077] [--min-time=200] [--repeat=5] [--threads=0]
+//                 [--filter=子串] [--json=文件|-] [--label=文本]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.h"
+#include "AnimGroup.h"
+#include "BenchCorpus.h"
+#include "CompactRow.h"
+#include "CsvReader.h"
+#include "DirClassCache.h"
+#include "ParseNumber.h"
+#include "StringKernels.h"
+
+namespace
+{
+    struct BenchOptions
+    {
+        size_t rows = 200000;
+        uint64_t seed = 2077;
+        unsigned min_time_ms = 200;  // 每个基准的最短计时时间（分摊到各次采样）
+        unsigned repeat = 5;         // 采样次数，取最快和中位数
+        size_t threads = 0;          // classifyRows 使用的线程数，0 为硬件线程数
+        std::string filter;
+        std::string json_path;
+        std::string label;
+    };
+
+    struct BenchResult
+    {
+        std::string name;
+        size_t rows;
+        size_t passes;              // 计时期间处理整个语料的次数
+        double best_ns_per_row;
+        double median_ns_per_row;
+        double allocs_per_row;
+        double bytes_per_row;
+    };
+
+    // 防止被测调用被优化掉
+    volatile size_t g_sink = 0;
+
+    inline void sink(size_t value)
+    {
+        g_sink = g_sink + value;
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    // pass() 处理整个语料一次。先预热一次，再单独跑一次统计分配，最后采样 repeat 次：
+    // 每次采样重复若干遍，使采样时间不少于 min_time / repeat
+    template <typename Pass>
+    BenchResult run_bench(const char* name, size_t rows, const BenchOptions& options, Pass pass)
+    {
+        BenchResult result{name, rows, 0, 0, 0, 0, 0};
+        pass();
+
+        const AllocSnapshot before = alloc_snapshot();
+        const Clock::time_point calibrate_start = Clock::now();
+        pass();
+        const double single_ns =
+            std::chrono::duration<double, std::nano>(Clock::now() - calibrate_start).count();
+        const AllocSnapshot after = alloc_snapshot();
+        result.allocs_per_row = static_cast<double>(after.count - before.count) / rows;
+        result.bytes_per_row = static_cast<double>(after.bytes - before.bytes) / rows;
+
+        const double sample_ns = static_cast<double>(options.min_time_ms) * 1e6 / std::max(1u, options.repeat);
+        const size_t passes_per_sample =
+            std::max<size_t>(1, static_cast<size_t>(sample_ns / std::max(1.0, single_ns)));
+        std::vector<double> samples;
+        for (unsigned r = 0; r < std::max(1u, options.repeat); ++r) {
+            const Clock::time_point start = Clock::now();
+            for (size_t p = 0; p < passes_per_sample; ++p) {
+                pass();
+            }
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(ns / (static_cast<double>(passes_per_sample) * rows));
+            result.passes += passes_per_sample;
+        }
+        std::sort(samples.begin(), samples.end());
+        result.best_ns_per_row = samples.front();
+        result.median_ns_per_row = samples[samples.size() / 2];
+        return result;
+    }
+
+    // 数值参数：整个值必须是 [min, max] 内的十进制整数，否则输出错误
+    template <typename T>
+    bool parse_number(const std::string& arg, const char* text, T min, T max, T& value)
+    {
+        if (parse_unsigned(text, value) && value >= min && value <= max) return true;
+        std::cerr << "错误：参数值无效（" << min << " ~ " << max << "） -> " << arg << std::endl;
+        return false;
+    }
+
+    bool parse_options(int argc, char* argv[], BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const auto value_of = [&arg](const char* prefix) -> const char* {
+                const size_t length = std::char_traits<char>::length(prefix);
+                return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+            };
+            if (const char* v = value_of("--rows=")) {
+                if (!parse_number<size_t>(arg, v, 1, 100000000, options.rows)) return false;
+            } else if (const char* v = value_of("--seed=")) {
+                if (!parse_number<uint64_t>(arg, v, 0, UINT64_MAX, options.seed)) return false;
+            } else if (const char* v = value_of("--min-time=")) {
+                if (!parse_number<unsigned>(arg, v, 1, 600000, options.min_time_ms)) return false;
+            } else if (const char* v = value_of("--repeat=")) {
+                if (!parse_number<unsigned>(arg, v, 1, 1000, options.repeat)) return false;
+            } else if (const char* v = value_of("--threads=")) {
+                if (!parse_number<size_t>(arg, v, 0, 1024, options.threads)) return false;
+            } else if (const char* v = value_of("--filter=")) {
+                options.filter = v;
+            } else if (const char* v = value_of("--json=")) {
+                options.json_path = v;
+            } else if (const char* v = value_of("--label=")) {
+                options.label = v;
+            } else {
+                std::cerr << "错误：未知参数 -> " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 编译目标架构：Win32 与 x64 的结果不能直接比较
+    const char* target_arch()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return "x64";
+#elif defined(_M_IX86) || defined(__i386__)
+        return "x86";
+#elif defined(_M_ARM64) || defined(__aarch64__)
+        return "arm64";
+#else
+        return "unknown";
+#endif
+    }
+
+    std::string json_escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped.push_back('\\');
+            if (static_cast<unsigned char>(c) >= 0x20) escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    void write_json(std::ostream& out, const BenchOptions& options, const BenchCorpus& corpus,
+                    const std::vector<BenchResult>& results)
+    {
+        out << std::fixed << std::setprecision(3);
+        out << "{\"suite\":\"anim_classifier\",\"label\":\"" << json_escape(options.label) << "\""
+            << ",\"corpus\":{\"rows\":" << corpus.size() << ",\"seed\":" << options.seed
+            << ",\"dirs\":" << corpus.dir_count() << ",\"path_bytes\":" << corpus.path_bytes() << "}"
+            << ",\"arch\":\"" << target_arch() << "\""
+            << ",\"string_kernels\":\"" << StringKernels::backendName() << "\""
+            << ",\"results\":[";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << (i > 0 ? "," : "") << "\n  {\"name\":\"" << r.name << "\""
+                << ",\"ns_per_row\":" << r.best_ns_per_row
+                << ",\"ns_per_row_median\":" << r.median_ns_per_row
+                << ",\"rows_per_sec\":" << (r.best_ns_per_row > 0 ? 1e9 / r.best_ns_per_row : 0.0)
+                << ",\"allocs_per_row\":" << r.allocs_per_row
+                << ",\"bytes_per_row\":" << r.bytes_per_row
+                << ",\"passes\":" << r.passes << "}";
+        }
+        out << "\n]}\n";
+    }
+
+    void print_table(std::ostream& out, const std::vector<BenchResult>& results)
+    {
+        // 表头与 JSON 字段名一致（中文在 setw 下无法对齐）
+        out << std::left << std::setw(26) << "name" << std::right
+            << std::setw(12) << "ns/row" << std::setw(12) << "median" << std::setw(14) << "rows/sec"
+            << std::setw(12) << "allocs/row" << std::setw(12) << "bytes/row" << "\n";
+        out << std::fixed;
+        for (const BenchResult& r : results) {
+            out << std::left << std::setw(26) << r.name << std::right << std::setprecision(1)
+                << std::setw(12) << r.best_ns_per_row << std::setw(12) << r.median_ns_per_row
+                << std::setprecision(0) << std::setw(14) << (r.best_ns_per_row > 0 ? 1e9 / r.best_ns_per_row : 0.0)
+                << std::setprecision(2) << std::setw(12) << r.allocs_per_row << std::setw(12) << r.bytes_per_row
+                << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    BenchCorpus corpus;
+    corpus.generate(options.rows, options.seed);
+    const std::vector<BenchCorpus::Entry>& entries = corpus.entries();
+    const size_t rows = corpus.size();
+    std::cout << "语料：" << rows << " 行，" << corpus.dir_count() << " 个目录，平均路径长度 "
+              << corpus.path_bytes() / rows << " 字节，" << target_arch()
+              << "，字符串内核 " << StringKernels::backendName() << std::endl;
+
+    // 各基准的输入在计时之外准备好
+    AnimsClassifier classifier;
+    std::vector<CSVRow> csv_rows(rows);
+    std::vector<std::string> relatives(rows);
+    std::vector<std::string> filenames(rows);
+    std::vector<AnimRuleMatcher::Hits> hits(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        csv_rows[i].index = std::to_string(i + 1);
+        csv_rows[i].fullpath = entries[i].full_path;
+        csv_rows[i].filename = entries[i].full_path.substr(entries[i].name_offset);
+        filenames[i] = csv_rows[i].filename;
+        relatives[i] = classifier.extractRelativePath(entries[i].full_path);
+        classifier.matchRules(relatives[i], hits[i]);
+    }
+    classifier.classifyRows(csv_rows, options.threads);
+    std::vector<std::string> csv_lines(rows);
+    {
+        std::ostringstream line;
+        for (size_t i = 0; i < rows; ++i) {
+            line.str(std::string());
+            writeClassifiedFields(line, csv_rows[i]);
+            csv_lines[i] = line.str();
+        }
+    }
+
+    std::vector<BenchResult> results;
+    const auto bench = [&](const char* name, auto pass) {
+        if (!options.filter.empty() && std::string(name).find(options.filter) == std::string::npos) {
+            return;
+        }
+        results.push_back(run_bench(name, rows, options, pass));
+        std::cout << "  " << name << " 完成" << std::endl;
+    };
+
+    bench("extractRelativePath", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(classifier.extractRelativePath(entries[i].full_path).size());
+    });
+    bench("getTopCategory", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(classifier.getTopCategory(relatives[i]).size());
+    });
+    bench("getSubCategory", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(classifier.getSubCategory(relatives[i]).size());
+    });
+    bench("getDepth", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(static_cast<size_t>(classifier.getDepth(relatives[i])));
+    });
+    bench("getCharacterPrefix", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(classifier.getCharacterPrefix(filenames[i]).size());
+    });
+    bench("matchRules", [&] {
+        AnimRuleMatcher::Hits row_hits;
+        for (size_t i = 0; i < rows; ++i) {
+            row_hits = AnimRuleMatcher::Hits();
+            classifier.matchRules(relatives[i], row_hits);
+            sink(static_cast<size_t>(row_hits.bits[0] ^ row_hits.bits[5]));
+        }
+    });
+    bench("formatRules", [&] {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t g = 0; g < kRuleGroupCount; ++g) {
+                sink(classifier.formatRules(static_cast<RuleGroup>(g), hits[i]).size());
+            }
+        }
+    });
+    bench("classifyRow", [&] {
+        for (size_t i = 0; i < rows; ++i) {
+            classifier.classifyRow(csv_rows[i]);
+            sink(csv_rows[i].bodyType.size());
+        }
+    });
+    // 每遍使用新的缓存，包含每个目录第一次出现时的完整分类
+    bench("classifyRow_dirCache", [&] {
+        DirClassCache cache;
+        for (size_t i = 0; i < rows; ++i) {
+            classifier.classifyRow(csv_rows[i], entries[i].dir_id, cache);
+            sink(csv_rows[i].bodyType.size());
+        }
+    });
+    bench("classifyRows_parallel", [&] {
+        classifier.classifyRows(csv_rows, options.threads);
+        sink(csv_rows[rows - 1].bodyType.size());
+    });
+    {
+        CompactRowTable table(classifier);
+        table.reserve(rows, corpus.path_bytes());
+        bench("CompactRowTable_add", [&] {
+            table.clear();
+            for (size_t i = 0; i < rows; ++i) {
+                table.add(entries[i].full_path, filenames[i], entries[i].dir_id);
+            }
+            sink(table.size());
+        });
+    }
+    bench("escapeCSV", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(escapeCSV(entries[i].full_path).size());
+    });
+    {
+        std::ostringstream out;
+        bench("writeClassifiedRow", [&] {
+            out.str(std::string());
+            for (size_t i = 0; i < rows; ++i) writeClassifiedRow(out, csv_rows[i]);
+            sink(static_cast<size_t>(out.tellp()));
+        });
+    }
+    bench("parseCSVLine", [&] {
+        for (size_t i = 0; i < rows; ++i) sink(parseCSVLine(csv_lines[i]).size());
+    });
+    {
+        // 同样的行拼成一个文件的内容，字段直接指向原文
+        std::string csv_text;
+        for (size_t i = 0; i < rows; ++i) {
+            csv_text += csv_lines[i];
+            csv_text += '\n';
+        }
+        CsvReader reader;
+        reader.assign(csv_text);
+        bench("CsvReader", [&] {
+            CsvReader::Cursor cursor = reader.rows();
+            CsvRow row;
+            while (cursor.next(row)) sink(row.size());
+        });
+    }
+
+    std::cout << "\n";
+    print_table(std::cout, results);
+
+    if (!options.json_path.empty()) {
+        if (options.json_path == "-") {
+            write_json(std::cout, options, corpus, results);
+        } else {
+            std::ofstream json_file(options.json_path, std::ios::out | std::ios::trunc);
+            if (!json_file.is_open()) {
+                std::cerr << "错误：无法创建/打开 JSON 文件 -> " << options.json_path << std::endl;
+                return 1;
+            }
+            write_json(json_file, options, corpus, results);
+            std::cout << "JSON 结果已写入：" << options.json_path << std::endl;
+        }
+    }
+    return 0;
+}
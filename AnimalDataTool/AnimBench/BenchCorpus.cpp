@@ -0,0 +1,219 @@
+﻿#include "BenchCorpus.h"
+
+namespace
+{
+    const char* const kRoot = "D:\\CDPR2077\\r6\\depot\\base\\animations\\";
+    const char* const kOutsideRoot = "D:\\CDPR2077\\r6\\depot\\base\\gameplay\\";
+
+    // splitmix64：输出只由 seed 决定
+    class Rng
+    {
+    public:
+        explicit Rng(uint64_t seed) : m_state(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+        // 概率为 percent%
+        bool chance(unsigned percent) { return next() % 100 < percent; }
+
+        // 按 1/(rank+1) 的权重选择：排在前面的词出现得多
+        size_t zipf(size_t n)
+        {
+            double total = 0;
+            for (size_t i = 0; i < n; ++i) total += 1.0 / static_cast<double>(i + 1);
+            double pick = static_cast<double>(next() >> 11) / static_cast<double>(1ull << 53) * total;
+            for (size_t i = 0; i < n; ++i) {
+                pick -= 1.0 / static_cast<double>(i + 1);
+                if (pick < 0) return i;
+            }
+            return n - 1;
+        }
+
+    private:
+        uint64_t m_state;
+    };
+
+    template <size_t N>
+    const char* pick(Rng& rng, const char* const (&words)[N])
+    {
+        return words[rng.below(N)];
+    }
+
+    template <size_t N>
+    const char* pick_zipf(Rng& rng, const char* const (&words)[N])
+    {
+        return words[rng.zipf(N)];
+    }
+
+    const char* const kBodies[] = {
+        "male_average", "female_average", "male_big", "male_fat",
+        "male_massive", "male_child", "female_child", "female_chubby",
+    };
+    const char* const kPrefixes[] = {"pma_", "pwa_", "ma_", "wa_", "cw_", "face_"};
+    // 前面的动作更常见；也混入不属于任何规则的词
+    const char* const kActions[] = {
+        "idle", "stand", "walk", "sit", "run", "combat", "lean", "talk", "attack", "crouch",
+        "loop", "turn", "kneel", "lie", "takedown", "finisher", "enter", "exit", "look", "point",
+    };
+    const char* const kWeapons[] = {
+        "handgun", "rifle_assault", "smg", "shotgun", "revolver", "katana", "knife", "rifle_precision",
+        "rifle_sniper", "lmg", "baton", "melee_fists", "one_handed_blunt", "two_handed_blunt",
+    };
+    const char* const kCyberware[] = {
+        "mantisblade", "monowire", "strongarms", "launcher", "personal_link", "armshield", "jammer",
+    };
+    const char* const kTags[] = {"transition", "fpp", "tpp", "sync", "gesture", "work", "facial"};
+    const char* const kDetails[] = {
+        "chair", "wall", "bar", "table", "counter", "start", "stop", "fast", "slow", "left", "right",
+        "up", "down", "short", "long", "a", "b", "intro", "outro", "reaction",
+    };
+    const char* const kScenes[] = {"cutscene", "gameplay", "interactive_scene", "open_world"};
+    const char* const kQuestKinds[] = {"main_quests", "side_quests", "minor_quests", "street_stories"};
+    const char* const kQuestNames[] = {
+        "heist", "pickup", "rescue", "ripperdoc", "bar", "apartment", "nomad", "corpo", "afterlife", "badlands",
+    };
+    const char* const kNpcKinds[] = {"generic", "gang", "corpo", "police", "civilian"};
+    const char* const kNpcSets[] = {"locomotion", "combat", "work", "idle_sets", "reactions"};
+    const char* const kFacialKinds[] = {"lipsync", "expressions", "gestures", "reactions"};
+    const char* const kCharacters[] = {"judy", "panam", "river", "kerry", "johnny", "jackie", "takemura", "rogue"};
+    const char* const kWeaponSets[] = {"reload", "shoot", "equip", "inspect", "melee"};
+    const char* const kSyncedKinds[] = {"takedowns", "finishers", "grapple", "interactions"};
+    const char* const kVehicleKinds[] = {"car", "bike", "av"};
+    const char* const kSeats[] = {"driver", "passenger", "combat"};
+    const char* const kItemKinds[] = {"consumables", "props", "devices"};
+    const char* const kUiKinds[] = {"menus", "photomode"};
+    const char* const kMarketingKinds[] = {"trailers", "promo"};
+
+    // 生成一个目录（以分隔符结尾）
+    std::string make_dir(Rng& rng)
+    {
+        std::string dir;
+        const size_t top = rng.below(100);
+        if (top < 2) {
+            dir = kOutsideRoot;
+            dir += pick(rng, kNpcSets);
+            dir += '\\';
+            return dir;
+        }
+        dir = kRoot;
+        const auto add = [&dir](const std::string& part) {
+            dir += part;
+            dir += '\\';
+        };
+        if (top < 32) {
+            add("quest");
+            add(pick_zipf(rng, kQuestKinds));
+            add("q" + std::to_string(100 + rng.below(120)) + "_" + pick(rng, kQuestNames));
+            if (rng.chance(60)) add(pick_zipf(rng, kScenes));
+        } else if (top < 56) {
+            add("npc");
+            add(pick_zipf(rng, kNpcKinds));
+            add(pick_zipf(rng, kBodies));
+            if (rng.chance(70)) add(pick_zipf(rng, kNpcSets));
+        } else if (top < 66) {
+            add("facial");
+            add(pick_zipf(rng, kFacialKinds));
+            add(pick(rng, kCharacters));
+        } else if (top < 76) {
+            add("weapon");
+            add(rng.chance(50) ? "fpp" : "tpp");
+            add(pick_zipf(rng, kWeapons));
+            if (rng.chance(50)) add(pick(rng, kWeaponSets));
+        } else if (top < 84) {
+            add("synced");
+            add(pick_zipf(rng, kSyncedKinds));
+            if (rng.chance(50)) add(pick_zipf(rng, kBodies));
+        } else if (top < 90) {
+            add("vehicle");
+            add(pick(rng, kVehicleKinds));
+            add(pick(rng, kSeats));
+        } else if (top < 95) {
+            add("items");
+            add(pick(rng, kItemKinds));
+        } else if (top < 98) {
+            add("ui");
+            add(pick(rng, kUiKinds));
+        } else {
+            add("marketing");
+            add(pick(rng, kMarketingKinds));
+        }
+        return dir;
+    }
+
+    void append_file_name(Rng& rng, bool weapon_tree, std::string& path)
+    {
+        if (rng.chance(40)) {
+            path += pick_zipf(rng, kPrefixes);
+        } else if (rng.chance(30)) {
+            path += pick_zipf(rng, kBodies);
+            path += "__";
+        }
+        path += pick_zipf(rng, kActions);
+        if (rng.chance(weapon_tree ? 70 : 10)) {
+            path += '_';
+            path += pick_zipf(rng, kWeapons);
+        }
+        if (rng.chance(5)) {
+            path += '_';
+            path += pick_zipf(rng, kCyberware);
+        }
+        for (size_t i = rng.below(3); i > 0; --i) {
+            path += '_';
+            path += pick_zipf(rng, kDetails);
+        }
+        if (rng.chance(20)) {
+            path += '_';
+            path += pick_zipf(rng, kTags);
+        }
+        // 变体：编号、左右镜像、var
+        const size_t variant = rng.below(100);
+        if (variant < 60) {
+            const size_t number = 1 + rng.below(12);
+            path += number < 10 ? "_0" : "_";
+            path += std::to_string(number);
+        } else if (variant < 70) {
+            path += rng.chance(50) ? "_l" : "_r";
+        } else if (variant < 75) {
+            path += "_var";
+        }
+        path += ".anims";
+    }
+}
+
+BenchCorpus::BenchCorpus()
+{
+}
+
+void BenchCorpus::generate(size_t rows, uint64_t seed)
+{
+    m_entries.clear();
+    m_entries.reserve(rows);
+    m_dirCount = 0;
+    m_pathBytes = 0;
+
+    Rng rng(seed);
+    while (m_entries.size() < rows) {
+        const std::string dir = make_dir(rng);
+        const bool weapon_tree = dir.find("\\weapon\\") != std::string::npos ||
+                                 dir.find("\\combat\\") != std::string::npos;
+        // 每个目录 1~48 个文件
+        const size_t files = 1 + rng.below(48);
+        for (size_t f = 0; f < files && m_entries.size() < rows; ++f) {
+            Entry entry;
+            entry.full_path = dir;
+            entry.name_offset = static_cast<uint32_t>(dir.size());
+            entry.dir_id = static_cast<uint32_t>(m_dirCount);
+            append_file_name(rng, weapon_tree, entry.full_path);
+            m_pathBytes += entry.full_path.size();
+            m_entries.push_back(std::move(entry));
+        }
+        ++m_dirCount;
+    }
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 合成的 depot 路径语料：目录树按 quest/npc/facial/weapon/... 的比例生成，
+// 文件名由 角色前缀 + 体型 + 动作 + 武器/义体 + 编号/镜像 等词组成，词的出现频率近似真实数据（少数词占多数）。
+// 同一目录下的文件相邻，与遍历结果的顺序一致。随机数生成不依赖标准库分布，同一 seed 在任何编译器下结果相同
+class BenchCorpus
+{
+public:
+    struct Entry
+    {
+        std::string full_path;
+        uint32_t name_offset;  // 文件名在完整路径中的起点
+        uint32_t dir_id;       // 目录编号（每生成一个目录分配一个，从 0 开始），同一目录的文件相同
+    };
+
+    BenchCorpus();
+
+    // 生成 rows 行（已有内容会被清空）
+    void generate(size_t rows, uint64_t seed);
+
+    const std::vector<Entry>& entries() const { return m_entries; }
+    size_t size() const { return m_entries.size(); }
+    size_t dir_count() const { return m_dirCount; }
+    // 所有完整路径的字节数
+    size_t path_bytes() const { return m_pathBytes; }
+
+private:
+    std::vector<Entry> m_entries;
+    size_t m_dirCount = 0;
+    size_t m_pathBytes = 0;
+};
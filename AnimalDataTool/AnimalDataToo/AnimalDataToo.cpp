@@ -3,12 +3,27 @@
 #include <vector>
 #include <string>
 #include "libxl.h"
+#include "Class/Tool/AnimCategoryTree.h"
 #include "Class/Tool/AnimGroup.h"
 #include "Class/Tool/AnimGroupMethod.h"
+#include "Class/Tool/AnimStats.h"
+#include "Class/Tool/AnimWatcher.h"
 #include "Class/Tool/FindAnim.h"
+#include "Class/Tool/ParseNumber.h"
+#include "Class/Tool/ScanFilter.h"
+#include "Class/Tool/ScanStats.h"
 #include "Class/Tool/WriteTool.h"
 
 
+// 命令行中任意位置出现 flag 时返回 true
+static bool has_flag(int argc, char* argv[], const char* flag)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == flag) return true;
+    }
+    return false;
+}
+
 int main(int argc, char* argv[])
 {
     std::string folder = "G:\\SoftApp\\Sy2077\\2077\\2077\\CDPR2077\\r6\\depot\\base\\animations";
@@ -33,15 +48,251 @@ int main(int argc, char* argv[])
     std::string csv_output_path_ui = "Animalui文件列表.csv";
     std::string csv_output_path_vehicle = "Animalvehicle文件列表.csv";
     std::string csv_output_path_weapon = "Animalweapon文件列表.csv";
-    anim_group_method->AnimSCVCreate(folder,true,csv_output_path);
-    anim_group_method->AnimSCVCreate(folder_quest,true,csv_output_path_quest);
-    anim_group_method->AnimSCVCreate(folder_npc,true,csv_output_path_npc);
-    anim_group_method->AnimSCVCreate(folder_items,true,csv_output_path_facial);
-    anim_group_method->AnimSCVCreate(folder_marketing,true,csv_output_path_items);
-    anim_group_method->AnimSCVCreate(folder_synced,true,csv_output_path_marketing);
-    anim_group_method->AnimSCVCreate(folder_ui,true,csv_output_path_ui);
-    anim_group_method->AnimSCVCreate(folder_vehicle,true,csv_output_path_vehicle);
-    anim_group_method->AnimSCVCreate(folder_weapon,true,csv_output_path_weapon); 
+    // 只遍历一次根目录，按路径前缀同时生成根目录和各分类的 CSV；
+    // 默认开启增量模式（--full 关闭），游戏更新后重跑只重新列举有变化的目录
+    std::vector<AnimCSVOutput> category_outputs = {
+        {folder_quest, csv_output_path_quest},
+        {folder_npc, csv_output_path_npc},
+        {folder_facial, csv_output_path_facial},
+        {folder_items, csv_output_path_items},
+        {folder_marketing, csv_output_path_marketing},
+        {folder_synced, csv_output_path_synced},
+        {folder_ui, csv_output_path_ui},
+        {folder_vehicle, csv_output_path_vehicle},
+        {folder_weapon, csv_output_path_weapon},
+    };
+
+    // --stats[=json|=prom] [--stats-interval=秒]：扫描结束时输出统计摘要，指定间隔时扫描期间定期输出
+    {
+        bool stats_enabled = false;
+        ScanStatsFormat stats_format = ScanStatsFormat::Json;
+        unsigned stats_interval = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--stats" || arg == "--stats=json") {
+                stats_enabled = true;
+            } else if (arg == "--stats=prom") {
+                stats_enabled = true;
+                stats_format = ScanStatsFormat::Prometheus;
+            } else if (arg.compare(0, 17, "--stats-interval=") == 0) {
+                // 间隔最长一天，更大的值多半是输入错误
+                if (!parse_unsigned(arg.substr(17), stats_interval) || stats_interval > 24 * 60 * 60) {
+                    std::cerr << "错误：统计间隔无效（0 ~ 86400 秒） -> " << arg << std::endl;
+                    delete anim_group_method;
+                    return 1;
+                }
+            }
+        }
+        if (stats_enabled) {
+            anim_group_method->EnableScanStats(stats_format, stats_interval);
+        }
+    }
+
+    // --include=glob / --exclude=glob / --ext=.anims：遍历时过滤，被排除的目录不会被打开
+    ScanFilter scan_filter;
+    {
+        bool filter_enabled = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 10, "--include=") == 0) {
+                scan_filter.add_include(arg.substr(10));
+                filter_enabled = true;
+            } else if (arg.compare(0, 10, "--exclude=") == 0) {
+                scan_filter.add_exclude(arg.substr(10));
+                filter_enabled = true;
+            } else if (arg.compare(0, 6, "--ext=") == 0) {
+                scan_filter.add_extension(arg.substr(6));
+                filter_enabled = true;
+            }
+        }
+        if (filter_enabled) {
+            // 游戏目录在 Windows 下不区分大小写
+            scan_filter.set_case_sensitive(false);
+            scan_filter.compile();
+            anim_group_method->SetScanFilter(&scan_filter);
+        }
+    }
+
+    // --threads=N：并行遍历、哈希、文件头解析、聚类和重新分类使用的线程数，0（默认）为全部硬件线程
+    size_t thread_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--threads=") == 0) {
+            if (!parse_unsigned(arg.substr(10), thread_count) || thread_count > 1024) {
+                std::cerr << "错误：线程数无效（0 ~ 1024） -> " << arg << std::endl;
+                delete anim_group_method;
+                return 1;
+            }
+        }
+    }
+
+    // --rules=规则文件：用自定义规则代替内置规则分类（文件格式与 AnimsClassifier::saveRules 导出的相同）
+    AnimsClassifier classifier;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 8, "--rules=") == 0) {
+            if (!classifier.loadRules(arg.substr(8))) {
+                std::cerr << "错误：分类规则加载失败 -> " << arg.substr(8) << std::endl;
+                delete anim_group_method;
+                return 1;
+            }
+            anim_group_method->SetClassifier(&classifier);
+        }
+    }
+
+    // --watch：常驻监视模式，首次扫描后只在目录变化时重写受影响的 CSV
+    if (has_flag(argc, argv, "--watch")) {
+        // 监视模式只维护文件列表：不使用过滤器和分类规则，也不输出扫描统计
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 10, "--include=") == 0 || arg.compare(0, 10, "--exclude=") == 0 ||
+                arg.compare(0, 6, "--ext=") == 0 || arg.compare(0, 7, "--stats") == 0 ||
+                arg.compare(0, 8, "--rules=") == 0 || arg.compare(0, 10, "--threads=") == 0) {
+                std::cerr << "警告：监视模式不支持该参数，已忽略 -> " << arg << std::endl;
+            }
+        }
+        AnimWatcher watcher;
+        const bool watched = watcher.run(folder, csv_output_path, category_outputs);
+        delete anim_group_method;
+        return watched ? 0 : 1;
+    }
+
+    // --group-by=weapon,action [--group-by=top ...] [--group-by-format=csv|json]：递归查找并分类后
+    // 按指定列做分组统计输出到标准输出（列名见 statColumnName），不写 CSV
+    {
+        std::vector<std::vector<StatColumn>> group_by;
+        AnimStatsFormat group_by_format = AnimStatsFormat::Console;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 11, "--group-by=") == 0) {
+                std::vector<StatColumn> columns;
+                if (!parseStatColumns(arg.substr(11), columns)) {
+                    delete anim_group_method;
+                    return 1;
+                }
+                group_by.push_back(columns);
+            } else if (arg == "--group-by-format=csv") {
+                group_by_format = AnimStatsFormat::Csv;
+            } else if (arg == "--group-by-format=json") {
+                group_by_format = AnimStatsFormat::Json;
+            }
+        }
+        if (!group_by.empty()) {
+            anim_group_method->AnimClassifyStatistics(folder, true, group_by, group_by_format);
+            delete anim_group_method;
+            return 0;
+        }
+    }
+
+    // --category-tree[=层数] [--tree-query=quest/main_quests ...] [--category-tree-format=csv|json]：
+    // 递归查找并分类后输出目录前缀树（各目录的文件总数和分类直方图），指定查询时只输出这些目录及其子树
+    {
+        bool category_tree = false;
+        size_t tree_depth = AnimCategoryTree::kUnlimitedDepth;
+        std::vector<std::string> tree_queries;
+        AnimStatsFormat tree_format = AnimStatsFormat::Console;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--category-tree") {
+                category_tree = true;
+            } else if (arg.compare(0, 16, "--category-tree=") == 0) {
+                category_tree = true;
+                if (!parse_unsigned(arg.substr(16), tree_depth)) {
+                    std::cerr << "错误：目录树层数无效 -> " << arg << std::endl;
+                    delete anim_group_method;
+                    return 1;
+                }
+            } else if (arg.compare(0, 13, "--tree-query=") == 0) {
+                category_tree = true;
+                tree_queries.push_back(arg.substr(13));
+            } else if (arg == "--category-tree-format=csv") {
+                tree_format = AnimStatsFormat::Csv;
+            } else if (arg == "--category-tree-format=json") {
+                tree_format = AnimStatsFormat::Json;
+            }
+        }
+        if (category_tree) {
+            anim_group_method->AnimCategoryTreeReport(folder, true, tree_queries, tree_depth, tree_format);
+            delete anim_group_method;
+            return 0;
+        }
+    }
+
+    // --reclassify=旧.csv [--reclassify-out=差异.csv]：读取之前生成的分类 CSV，用当前规则重新分类并输出有变化的行
+    {
+        std::string reclassify_csv;
+        std::string reclassify_out;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 13, "--reclassify=") == 0) {
+                reclassify_csv = arg.substr(13);
+            } else if (arg.compare(0, 17, "--reclassify-out=") == 0) {
+                reclassify_out = arg.substr(17);
+            }
+        }
+        if (!reclassify_csv.empty()) {
+            anim_group_method->AnimReclassifyDiff(reclassify_csv, reclassify_out, thread_count);
+            delete anim_group_method;
+            return 0;
+        }
+    }
+
+    // --archives=archive目录 --hash-list=哈希列表：不解包直接索引 .archive 文件，用哈希列表还原 .anims 路径，
+    // 输出带分类列的 CSV（--include/--exclude/--ext 作用于还原后的路径）
+    {
+        std::string archive_folder;
+        std::string hash_list_path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 11, "--archives=") == 0) {
+                archive_folder = arg.substr(11);
+            } else if (arg.compare(0, 12, "--hash-list=") == 0) {
+                hash_list_path = arg.substr(12);
+            }
+        }
+        if (!archive_folder.empty() || !hash_list_path.empty()) {
+            if (archive_folder.empty() || hash_list_path.empty()) {
+                std::cerr << "错误：--archives 和 --hash-list 必须同时指定" << std::endl;
+                delete anim_group_method;
+                return 1;
+            }
+            anim_group_method->AnimSCVCreateFromArchives(archive_folder, hash_list_path, csv_output_path);
+            delete anim_group_method;
+            return 0;
+        }
+    }
+
+    // --hash：递归查找后计算内容哈希，CSV 增加 content_hash 列并输出重复文件分组
+    if (has_flag(argc, argv, "--hash")) {
+        anim_group_method->AnimSCVCreateWithContentHash(folder, true, csv_output_path, thread_count);
+        delete anim_group_method;
+        return 0;
+    }
+
+    // --meta：递归查找后解析每个 .anims 的文件头，CSV 增加动画数量、骨骼、动画名称和时长
+    if (has_flag(argc, argv, "--meta")) {
+        anim_group_method->AnimSCVCreateWithMetadata(folder, true, csv_output_path, thread_count);
+        delete anim_group_method;
+        return 0;
+    }
+
+    // --name-groups：递归查找并分类后聚类近似重复的动画名称，CSV 增加 group_id 列
+    if (has_flag(argc, argv, "--name-groups")) {
+        anim_group_method->AnimSCVCreateWithNameGroups(folder, true, csv_output_path, thread_count);
+        delete anim_group_method;
+        return 0;
+    }
+
+    // --pipeline：扫描、分类、写出三个阶段并行，输出带分类列的 CSV（只写根目录 CSV）并打印各阶段吞吐
+    if (has_flag(argc, argv, "--pipeline")) {
+        anim_group_method->AnimSCVCreatePipelined(folder, true, csv_output_path);
+        delete anim_group_method;
+        return 0;
+    }
+
+    // 默认增量遍历（串行，只重新列举有变化的目录）；--full：不使用扫描清单，按 --threads 并行完整遍历
+    const bool full_scan = has_flag(argc, argv, "--full");
+    anim_group_method->AnimSCVCreateBatch(folder, csv_output_path, category_outputs, thread_count, !full_scan);
     std::cout << "开始测试 libxl 库..." << std::endl;
 
     // 创建一个 Book 对象
@@ -0,0 +1,454 @@
+﻿#include "AnimBuiltinRules.h"
+
+#include <cstdint>
+
+#include "StringKernels.h"
+
+// 自动机在编译期构造，MSVC 需要在工程中放宽 /constexpr:steps（默认上限不够构造完整转移表）
+namespace
+{
+    struct BuiltinRule
+    {
+        RuleGroup group;
+        const char* category;
+        const char* keywords;  // 以 '|' 分隔，\b 表示要求单词边界
+    };
+
+    // 顺序与原 initializePatterns 一致：武器/义体取规则顺序中第一个命中，特殊标签按规则顺序输出
+    constexpr BuiltinRule kRules[] = {
+        // 体型分类模式
+        {RuleGroup::Body, "male_average", "male_average|man_average"},
+        {RuleGroup::Body, "female_average", "female_average|woman_average"},
+        {RuleGroup::Body, "male_big", "male_big|man_big"},
+        {RuleGroup::Body, "male_fat", "male_fat|man_fat"},
+        {RuleGroup::Body, "male_massive", "male_massive|man_massive"},
+        {RuleGroup::Body, "male_child", "male_child|child_male|boy"},
+        {RuleGroup::Body, "female_child", "female_child|child_female|girl"},
+        {RuleGroup::Body, "female_chubby", "female_chubby|woman_chubby"},
+
+        // 动作类型模式
+        {RuleGroup::Action, "stand", "\\bstand"},
+        {RuleGroup::Action, "sit", "\\bsit"},
+        {RuleGroup::Action, "walk", "\\bwalk"},
+        {RuleGroup::Action, "run", "\\brun"},
+        {RuleGroup::Action, "idle", "\\bidle"},
+        {RuleGroup::Action, "combat", "\\bcombat"},
+        {RuleGroup::Action, "attack", "\\battack"},
+        {RuleGroup::Action, "takedown", "\\btakedown"},
+        {RuleGroup::Action, "finisher", "\\bfinisher"},
+        {RuleGroup::Action, "lean", "\\blean"},
+        {RuleGroup::Action, "lie", "\\blie"},
+        {RuleGroup::Action, "kneel", "\\bkneel"},
+        {RuleGroup::Action, "crouch", "\\bcrouch"},
+
+        // 场景类型模式
+        {RuleGroup::Scene, "interactive_scene", "interactive_scene"},
+        {RuleGroup::Scene, "open_world", "open_world"},
+        {RuleGroup::Scene, "gameplay", "gameplay"},
+        {RuleGroup::Scene, "cutscene", "cutscene"},
+
+        // 武器类型
+        {RuleGroup::Weapon, "handgun", "handgun"},
+        {RuleGroup::Weapon, "revolver", "revolver"},
+        {RuleGroup::Weapon, "smg", "smg"},
+        {RuleGroup::Weapon, "rifle_assault", "rifle_assault"},
+        {RuleGroup::Weapon, "rifle_precision", "rifle_precision"},
+        {RuleGroup::Weapon, "rifle_sniper", "rifle_sniper"},
+        {RuleGroup::Weapon, "shotgun", "shotgun"},
+        {RuleGroup::Weapon, "lmg", "lmg"},
+        {RuleGroup::Weapon, "katana", "katana"},
+        {RuleGroup::Weapon, "knife", "knife"},
+        {RuleGroup::Weapon, "baton", "baton"},
+        {RuleGroup::Weapon, "melee_fists", "melee_fists"},
+        {RuleGroup::Weapon, "one_handed_blunt", "one_handed_blunt"},
+        {RuleGroup::Weapon, "two_handed_blunt", "two_handed_blunt"},
+
+        // 义体类型
+        {RuleGroup::Cyberware, "mantisblade", "mantisblade"},
+        {RuleGroup::Cyberware, "monowire", "monowire"},
+        {RuleGroup::Cyberware, "launcher", "launcher"},
+        {RuleGroup::Cyberware, "strongarms", "strongarms"},
+        {RuleGroup::Cyberware, "personal_link", "personal_link"},
+        {RuleGroup::Cyberware, "armshield", "armshield"},
+        {RuleGroup::Cyberware, "jammer", "jammer"},
+
+        // 特殊标签
+        {RuleGroup::Tag, "Facial", "facial|face_"},
+        {RuleGroup::Tag, "Sync", "sync"},
+        {RuleGroup::Tag, "Finisher", "finisher"},
+        {RuleGroup::Tag, "Takedown", "takedown"},
+        {RuleGroup::Tag, "Transition", "transition"},
+        {RuleGroup::Tag, "FPP", "fpp"},
+        {RuleGroup::Tag, "TPP", "tpp"},
+        {RuleGroup::Tag, "Work", "work"},
+        {RuleGroup::Tag, "Gesture", "gesture"},
+        {RuleGroup::Tag, "Idle", "idle"},
+        {RuleGroup::Tag, "Combat", "combat"},
+    };
+
+    constexpr size_t kRuleCount = sizeof(kRules) / sizeof(kRules[0]);
+
+    // 角色前缀（顺序与原 std::map 的遍历顺序一致）
+    struct PrefixRule
+    {
+        const char* prefix;  // 含结尾的 '_'
+        const char* meaning;
+    };
+
+    constexpr PrefixRule kPrefixes[] = {
+        {"cw_", "Cyberware"},
+        {"face_", "Facial"},
+        {"ma_", "Male_Average"},
+        {"pma_", "Player_Male_Average"},
+        {"pwa_", "Player_Female_Average"},
+        {"wa_", "Female_Average"},
+    };
+
+    constexpr size_t kPrefixCount = sizeof(kPrefixes) / sizeof(kPrefixes[0]);
+
+    // ---- 编译期辅助函数 ----
+
+    constexpr size_t const_length(const char* text)
+    {
+        size_t length = 0;
+        while (text[length] != '\0') ++length;
+        return length;
+    }
+
+    constexpr bool const_less(const char* a, const char* b)
+    {
+        while (*a != '\0' && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+    }
+
+    constexpr char const_lower(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    constexpr bool is_sorted_group(RuleGroup group)
+    {
+        return group == RuleGroup::Body || group == RuleGroup::Action || group == RuleGroup::Scene;
+    }
+
+    // 关键字在规则字符串中的位置
+    struct KeywordRange
+    {
+        size_t begin;
+        size_t end;
+        bool wordStart;
+    };
+
+    // 读取 keywords 中从 pos 开始的下一个关键字，返回下一个关键字的起点（结束时为 npos）
+    constexpr size_t next_keyword(const char* keywords, size_t pos, KeywordRange& range)
+    {
+        range.wordStart = keywords[pos] == '\\' && keywords[pos + 1] == 'b';
+        range.begin = range.wordStart ? pos + 2 : pos;
+        range.end = range.begin;
+        while (keywords[range.end] != '\0' && keywords[range.end] != '|') ++range.end;
+        return keywords[range.end] == '|' ? range.end + 1 : static_cast<size_t>(-1);
+    }
+
+    struct KeywordTotals
+    {
+        size_t patterns;
+        size_t chars;
+    };
+
+    constexpr KeywordTotals count_keywords()
+    {
+        KeywordTotals totals{0, 0};
+        for (size_t r = 0; r < kRuleCount; ++r) {
+            KeywordRange range{0, 0, false};
+            for (size_t pos = 0; pos != static_cast<size_t>(-1);) {
+                pos = next_keyword(kRules[r].keywords, pos, range);
+                if (range.end == range.begin) continue;
+                ++totals.patterns;
+                totals.chars += range.end - range.begin;
+            }
+        }
+        return totals;
+    }
+
+    // 字符类：关键字中出现的字节各占一类，大写字母与小写共用一类，其余字节为类 0
+    struct ClassMap
+    {
+        uint8_t classOf[256];
+        size_t count;
+    };
+
+    constexpr ClassMap make_class_map()
+    {
+        ClassMap map{{}, 1};
+        for (size_t r = 0; r < kRuleCount; ++r) {
+            KeywordRange range{0, 0, false};
+            for (size_t pos = 0; pos != static_cast<size_t>(-1);) {
+                pos = next_keyword(kRules[r].keywords, pos, range);
+                for (size_t i = range.begin; i < range.end; ++i) {
+                    const unsigned char byte = static_cast<unsigned char>(const_lower(kRules[r].keywords[i]));
+                    if (map.classOf[byte] != 0) continue;
+                    map.classOf[byte] = static_cast<uint8_t>(map.count);
+                    if (byte >= 'a' && byte <= 'z') map.classOf[byte - 'a' + 'A'] = static_cast<uint8_t>(map.count);
+                    ++map.count;
+                }
+            }
+        }
+        return map;
+    }
+
+    constexpr KeywordTotals kTotals = count_keywords();
+    constexpr size_t kPatternCount = kTotals.patterns;
+    constexpr size_t kStateCapacity = kTotals.chars + 1;  // 上界：每个关键字字符最多新增一个状态
+    constexpr size_t kClassCount = make_class_map().count;
+
+    static_assert(kStateCapacity <= 0xFFFF, "内置规则的自动机状态超出 uint16_t");
+
+    struct PatternInfo
+    {
+        uint8_t group;
+        uint8_t bit;
+        uint8_t wordStart;
+        uint8_t length;
+    };
+
+    // 与 AnimRuleMatcher 相同的 Aho-Corasick 完整 DFA；每个状态只保存自己的输出，
+    // 沿 outNext 链可以遍历失败链上所有带输出的状态
+    struct Automaton
+    {
+        uint8_t classOf[256];
+        uint16_t delta[kStateCapacity * kClassCount];
+        uint16_t outBegin[kStateCapacity + 1];
+        uint16_t outputs[kPatternCount];
+        uint16_t outHead[kStateCapacity];  // 自身或失败链上第一个带输出的状态，0 表示没有
+        uint16_t outNext[kStateCapacity];  // 带输出状态在失败链上的下一个带输出状态
+        PatternInfo patterns[kPatternCount];
+        const char* names[kRuleGroupCount][64];  // 位序号 -> 分类名
+        uint8_t categoryCount[kRuleGroupCount];
+        size_t stateCount;
+    };
+
+    constexpr Automaton build_automaton()
+    {
+        Automaton a{};
+        const ClassMap map = make_class_map();
+        for (size_t i = 0; i < 256; ++i) a.classOf[i] = map.classOf[i];
+
+        // 1. 位序号：体型/动作/场景按分类名排序，其余按规则顺序
+        uint8_t bitOf[kRuleCount] = {};
+        for (size_t r = 0; r < kRuleCount; ++r) {
+            const RuleGroup group = kRules[r].group;
+            size_t bit = 0;
+            for (size_t other = 0; other < kRuleCount; ++other) {
+                if (other == r || kRules[other].group != group) continue;
+                if (is_sorted_group(group) ? const_less(kRules[other].category, kRules[r].category) : other < r) ++bit;
+            }
+            bitOf[r] = static_cast<uint8_t>(bit);
+            a.names[static_cast<size_t>(group)][bit] = kRules[r].category;
+            ++a.categoryCount[static_cast<size_t>(group)];
+        }
+
+        // 2. 关键字插入字典树（转移表中 0 表示没有子节点，根节点不会成为子节点）
+        uint16_t stateOf[kPatternCount] = {};
+        a.stateCount = 1;
+        size_t p = 0;
+        for (size_t r = 0; r < kRuleCount; ++r) {
+            KeywordRange range{0, 0, false};
+            for (size_t pos = 0; pos != static_cast<size_t>(-1);) {
+                pos = next_keyword(kRules[r].keywords, pos, range);
+                if (range.end == range.begin) continue;
+                size_t state = 0;
+                for (size_t i = range.begin; i < range.end; ++i) {
+                    const size_t cell = state * kClassCount + a.classOf[static_cast<unsigned char>(kRules[r].keywords[i])];
+                    if (a.delta[cell] == 0) a.delta[cell] = static_cast<uint16_t>(a.stateCount++);
+                    state = a.delta[cell];
+                }
+                a.patterns[p].group = static_cast<uint8_t>(kRules[r].group);
+                a.patterns[p].bit = bitOf[r];
+                a.patterns[p].wordStart = range.wordStart ? 1 : 0;
+                a.patterns[p].length = static_cast<uint8_t>(range.end - range.begin);
+                stateOf[p] = static_cast<uint16_t>(state);
+                ++p;
+            }
+        }
+
+        // 3. 按状态归并每个状态自己的输出
+        for (size_t i = 0; i < kPatternCount; ++i) ++a.outBegin[stateOf[i] + 1];
+        for (size_t s = 0; s < kStateCapacity; ++s) a.outBegin[s + 1] += a.outBegin[s];
+        uint16_t fill[kStateCapacity] = {};
+        for (size_t i = 0; i < kPatternCount; ++i) {
+            a.outputs[a.outBegin[stateOf[i]] + fill[stateOf[i]]++] = static_cast<uint16_t>(i);
+        }
+
+        // 4. 按层次遍历计算失败链并补全转移表。处理状态 s 时它的失败状态层次更浅，转移已经补全
+        uint16_t fail[kStateCapacity] = {};
+        uint16_t queue[kStateCapacity] = {};
+        size_t head = 0;
+        size_t tail = 0;
+        for (size_t cls = 0; cls < kClassCount; ++cls) {
+            if (a.delta[cls] != 0) queue[tail++] = a.delta[cls];
+        }
+        while (head < tail) {
+            const size_t s = queue[head++];
+            const size_t f = fail[s];
+            a.outHead[s] = a.outBegin[s] != a.outBegin[s + 1] ? static_cast<uint16_t>(s) : a.outHead[f];
+            a.outNext[s] = a.outHead[f];
+            for (size_t cls = 0; cls < kClassCount; ++cls) {
+                const uint16_t next = a.delta[s * kClassCount + cls];
+                const uint16_t fallback = a.delta[f * kClassCount + cls];
+                if (next != 0) {
+                    fail[next] = fallback;
+                    queue[tail++] = next;
+                } else {
+                    a.delta[s * kClassCount + cls] = fallback;
+                }
+            }
+        }
+        return a;
+    }
+
+    constexpr Automaton kAutomaton = build_automaton();
+
+    // ---- 角色前缀 ----
+
+    // 前缀按小端序打包成整数，与读入的文件名开头字节比较
+    constexpr uint64_t pack_prefix(const char* prefix)
+    {
+        uint64_t key = 0;
+        for (size_t i = 0; prefix[i] != '\0'; ++i) {
+            key |= uint64_t(static_cast<unsigned char>(prefix[i])) << (8 * i);
+        }
+        return key;
+    }
+
+    constexpr uint64_t prefix_mask(const char* prefix)
+    {
+        return const_length(prefix) >= 8 ? ~uint64_t(0) : (uint64_t(1) << (8 * const_length(prefix))) - 1;
+    }
+
+    struct PrefixKeys
+    {
+        uint64_t key[kPrefixCount];
+        uint64_t mask[kPrefixCount];
+    };
+
+    constexpr PrefixKeys make_prefix_keys()
+    {
+        PrefixKeys keys{};
+        for (size_t i = 0; i < kPrefixCount; ++i) {
+            keys.key[i] = pack_prefix(kPrefixes[i].prefix);
+            keys.mask[i] = prefix_mask(kPrefixes[i].prefix);
+        }
+        return keys;
+    }
+
+    constexpr PrefixKeys kPrefixKeys = make_prefix_keys();
+
+    constexpr bool prefixes_disjoint()
+    {
+        for (size_t i = 0; i < kPrefixCount; ++i) {
+            for (size_t j = 0; j < kPrefixCount; ++j) {
+                if (i == j) continue;
+                const uint64_t common = kPrefixKeys.mask[i] & kPrefixKeys.mask[j];
+                if ((kPrefixKeys.key[i] & common) == (kPrefixKeys.key[j] & common)) return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(prefixes_disjoint(), "角色前缀之间不能互为前缀，否则无分支比较的结果不唯一");
+    static_assert(const_length("face_") <= 8, "角色前缀最长 8 字节");
+
+    // 8 个字节中的 ASCII 大写字母同时转小写
+    inline uint64_t lower_ascii_word(uint64_t word)
+    {
+        const uint64_t ones = 0x0101010101010101ull;
+        const uint64_t low7 = word & (0x7F * ones);
+        const uint64_t atLeastA = low7 + (0x80 - 'A') * ones;
+        const uint64_t aboveZ = low7 + (0x80 - 'Z' - 1) * ones;
+        const uint64_t upper = atLeastA & ~aboveZ & ~word & (0x80 * ones);
+        return word | (upper >> 2);
+    }
+}
+
+size_t BuiltinAnimRules::match(std::string_view text, AnimRuleMatcher::Hits& hits, size_t from, size_t state)
+{
+    const Automaton& a = kAutomaton;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t length = text.size();
+    for (size_t i = from; i < length; ++i) {
+        state = a.delta[state * kClassCount + a.classOf[bytes[i]]];
+        for (size_t s = a.outHead[state]; s != 0; s = a.outNext[s]) {
+            for (size_t o = a.outBegin[s]; o < a.outBegin[s + 1]; ++o) {
+                const PatternInfo& pattern = a.patterns[a.outputs[o]];
+                if (pattern.wordStart) {
+                    const size_t start = i + 1 - pattern.length;
+                    if (start > 0 && StringKernels::isWordChar(bytes[start - 1])) continue;
+                }
+                hits.bits[pattern.group] |= uint64_t(1) << pattern.bit;
+            }
+        }
+    }
+    return state;
+}
+
+std::string BuiltinAnimRules::format(RuleGroup group, const AnimRuleMatcher::Hits& hits)
+{
+    const size_t g = static_cast<size_t>(group);
+    uint64_t bits = hits.bits[g];
+    std::string result;
+    while (bits != 0) {
+        if (!result.empty()) result += "; ";
+        result += kAutomaton.names[g][StringKernels::lowestBit(bits)];
+        if (group == RuleGroup::Weapon || group == RuleGroup::Cyberware) break;
+        bits &= bits - 1;
+    }
+    return result;
+}
+
+size_t BuiltinAnimRules::categoryCount(RuleGroup group)
+{
+    return kAutomaton.categoryCount[static_cast<size_t>(group)];
+}
+
+const char* BuiltinAnimRules::categoryName(RuleGroup group, size_t id)
+{
+    return kAutomaton.names[static_cast<size_t>(group)][id];
+}
+
+void BuiltinAnimRules::addTo(AnimRuleMatcher& matcher)
+{
+    for (const BuiltinRule& rule : kRules) {
+        matcher.addPattern(rule.group, rule.category, rule.keywords);
+    }
+    matcher.compile();
+}
+
+int BuiltinAnimRules::characterPrefix(std::string_view filename)
+{
+    // 读入开头最多 8 个字节（不足补 0），统一转小写后与每个前缀做整字比较，命中结果直接累加
+    uint64_t word = 0;
+    const size_t count = filename.size() < 8 ? filename.size() : 8;
+    for (size_t i = 0; i < count; ++i) {
+        word |= uint64_t(static_cast<unsigned char>(filename[i])) << (8 * i);
+    }
+    word = lower_ascii_word(word);
+
+    int id = -1;
+    for (size_t i = 0; i < kPrefixCount; ++i) {
+        id += static_cast<int>((word & kPrefixKeys.mask[i]) == kPrefixKeys.key[i]) * static_cast<int>(i + 1);
+    }
+    return id;
+}
+
+size_t BuiltinAnimRules::characterPrefixCount()
+{
+    return kPrefixCount;
+}
+
+const char* BuiltinAnimRules::characterPrefixName(size_t id)
+{
+    return kPrefixes[id].meaning;
+}
@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "AnimRuleMatcher.h"
+
+// 内置的 Cyberpunk 分类规则。规则表和多模式自动机都在编译期生成（constexpr），
+// 程序启动时不需要构造任何正则、map 或转移表。
+// 命中位序号、输出顺序与用同一份规则构造的 AnimRuleMatcher 完全一致，
+// 因此 AnimRuleMatcher::Hits 可以在两者之间通用。
+class BuiltinAnimRules
+{
+public:
+    // 参数与返回值同 AnimRuleMatcher::match
+    static size_t match(std::string_view text, AnimRuleMatcher::Hits& hits, size_t from = 0, size_t state = 0);
+    static std::string format(RuleGroup group, const AnimRuleMatcher::Hits& hits);
+
+    static size_t categoryCount(RuleGroup group);
+    // id 为位图中的位序号
+    static const char* categoryName(RuleGroup group, size_t id);
+
+    // 把内置规则添加到运行时匹配器并编译（用于导出规则文件，或作为自定义规则的起点）
+    static void addTo(AnimRuleMatcher& matcher);
+
+    // 角色前缀：文件名（不区分大小写）以 "前缀_" 开头时返回前缀序号，否则返回 -1。
+    // 前缀互不为前缀，最多只有一个命中，用无分支的整字比较实现
+    static int characterPrefix(std::string_view filename);
+    static size_t characterPrefixCount();
+    static const char* characterPrefixName(size_t id);
+};
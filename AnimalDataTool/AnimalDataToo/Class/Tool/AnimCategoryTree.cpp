@@ -0,0 +1,324 @@
+﻿#include "AnimCategoryTree.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "AnimGroup.h"
+#include "CompactRow.h"
+
+namespace
+{
+    const uint32_t kNoValue = 0xFFFFFFFFu;
+
+    std::string json_escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            const unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+                escaped.push_back(c);
+            } else if (byte < 0x20) {
+                const char* hex = "0123456789abcdef";
+                escaped += "\\u00";
+                escaped.push_back(hex[byte >> 4]);
+                escaped.push_back(hex[byte & 0xF]);
+            } else {
+                escaped.push_back(c);
+            }
+        }
+        return escaped;
+    }
+
+    // 相对路径中文件名之前的目录部分
+    std::string_view directory_of(std::string_view relative, bool slash_only)
+    {
+        const size_t last = slash_only ? relative.find_last_of('/') : relative.find_last_of("/\\");
+        return last == std::string_view::npos ? std::string_view() : relative.substr(0, last);
+    }
+}
+
+AnimCategoryTree::AnimCategoryTree(const std::vector<StatColumn>& histogram_columns)
+    : m_columns(histogram_columns)
+{
+    clear();
+}
+
+void AnimCategoryTree::clear()
+{
+    m_nodes.clear();
+    Node root;
+    root.parent = kNoNode;
+    root.depth = 0;
+    root.histograms.resize(m_columns.size());
+    m_nodes.push_back(std::move(root));
+
+    m_valueNames.assign(m_columns.size(), std::vector<std::string>());
+    m_valueIds.assign(m_columns.size(), std::unordered_map<std::string, uint32_t>());
+    m_lastDir.clear();
+    m_lastNode = kNoNode;
+}
+
+void AnimCategoryTree::build(const CompactRowTable& table)
+{
+    clear();
+    const size_t width = m_columns.size();
+    // 表内编码 -> 本树的值ID，按需填充
+    std::vector<std::vector<uint32_t>> code_map(width);
+    std::vector<uint32_t> codes(kMaxStatValues);
+    std::vector<uint32_t> value_ids(width * kMaxStatValues);
+    std::vector<size_t> counts(width);
+
+    for (size_t i = 0; i < table.size(); ++i) {
+        const CompactRow& row = table.row(i);
+        const std::string_view path = table.fullPath(i);
+        // 相对路径中的 '\' 在输出时才换成 '/'，这里两种都作为分隔符；没有 animations 目录时与 getTopCategory 一样只认 '/'
+        const bool slash_only = !row.hasRelative;
+        const std::string_view relative = row.hasRelative ? path.substr(row.relOffset) : path;
+        const uint32_t id = nodeFor(directory_of(relative, slash_only), slash_only);
+
+        for (size_t k = 0; k < width; ++k) {
+            counts[k] = statColumnCodes(row, m_columns[k], codes.data());
+            std::vector<uint32_t>& map = code_map[k];
+            for (size_t v = 0; v < counts[k]; ++v) {
+                const uint32_t code = codes[v];
+                if (code >= map.size()) map.resize(code + 1, kNoValue);
+                if (map[code] == kNoValue) map[code] = internValue(k, statColumnLabel(table, m_columns[k], code));
+                value_ids[k * kMaxStatValues + v] = map[code];
+            }
+        }
+        addFile(id, value_ids.data(), counts.data());
+    }
+}
+
+void AnimCategoryTree::build(const std::vector<CSVRow>& rows)
+{
+    clear();
+    const size_t width = m_columns.size();
+    std::vector<std::string> values;
+    std::vector<uint32_t> value_ids(width * kMaxStatValues);
+    std::vector<size_t> counts(width);
+
+    for (const CSVRow& row : rows) {
+        const uint32_t id = nodeFor(directory_of(row.relativePath, true), true);
+        for (size_t k = 0; k < width; ++k) {
+            counts[k] = statColumnValues(row, m_columns[k], values);
+            for (size_t v = 0; v < counts[k]; ++v) value_ids[k * kMaxStatValues + v] = internValue(k, values[v]);
+        }
+        addFile(id, value_ids.data(), counts.data());
+    }
+}
+
+uint32_t AnimCategoryTree::nodeFor(std::string_view dir, bool slash_only)
+{
+    if (m_lastNode != kNoNode && slash_only == m_lastSlashOnly && dir == m_lastDir) {
+        return m_lastNode;
+    }
+
+    uint32_t id = kRoot;
+    size_t begin = 0;
+    while (begin < dir.size()) {
+        size_t end = slash_only ? dir.find('/', begin) : dir.find_first_of("/\\", begin);
+        if (end == std::string_view::npos) end = dir.size();
+        if (end > begin) id = childFor(id, dir.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    m_lastDir.assign(dir.data(), dir.size());
+    m_lastSlashOnly = slash_only;
+    m_lastNode = id;
+    return id;
+}
+
+uint32_t AnimCategoryTree::childFor(uint32_t parent, std::string_view name)
+{
+    std::vector<uint32_t>& children = m_nodes[parent].children;
+    const auto it = std::lower_bound(children.begin(), children.end(), name,
+                                     [this](uint32_t child, std::string_view key) { return m_nodes[child].name < key; });
+    if (it != children.end() && m_nodes[*it].name == name) return *it;
+
+    const size_t position = static_cast<size_t>(it - children.begin());
+    const uint32_t id = static_cast<uint32_t>(m_nodes.size());
+    Node child;
+    child.name.assign(name.data(), name.size());
+    child.parent = parent;
+    child.depth = m_nodes[parent].depth + 1;
+    child.histograms.resize(m_columns.size());
+    // push_back 之后 children 引用失效，重新取父节点
+    m_nodes.push_back(std::move(child));
+    std::vector<uint32_t>& siblings = m_nodes[parent].children;
+    siblings.insert(siblings.begin() + position, id);
+    return id;
+}
+
+uint32_t AnimCategoryTree::childOf(uint32_t parent, std::string_view name) const
+{
+    const std::vector<uint32_t>& children = m_nodes[parent].children;
+    const auto it = std::lower_bound(children.begin(), children.end(), name,
+                                     [this](uint32_t child, std::string_view key) { return m_nodes[child].name < key; });
+    return it != children.end() && m_nodes[*it].name == name ? *it : kNoNode;
+}
+
+void AnimCategoryTree::addFile(uint32_t id, const uint32_t* value_ids, const size_t* counts)
+{
+    ++m_nodes[id].files;
+    for (uint32_t n = id; n != kNoNode; n = m_nodes[n].parent) {
+        Node& node = m_nodes[n];
+        ++node.totalFiles;
+        for (size_t k = 0; k < m_columns.size(); ++k) {
+            std::vector<std::pair<uint32_t, uint64_t>>& histogram = node.histograms[k];
+            for (size_t v = 0; v < counts[k]; ++v) {
+                const uint32_t value = value_ids[k * kMaxStatValues + v];
+                auto it = std::lower_bound(histogram.begin(), histogram.end(), value,
+                                           [](const std::pair<uint32_t, uint64_t>& entry, uint32_t key) {
+                                               return entry.first < key;
+                                           });
+                if (it == histogram.end() || it->first != value) it = histogram.insert(it, {value, 0});
+                ++it->second;
+            }
+        }
+    }
+}
+
+uint32_t AnimCategoryTree::internValue(size_t column, const std::string& value)
+{
+    auto inserted = m_valueIds[column].emplace(value, static_cast<uint32_t>(m_valueNames[column].size()));
+    if (inserted.second) m_valueNames[column].push_back(value);
+    return inserted.first->second;
+}
+
+uint32_t AnimCategoryTree::find(std::string_view dirPath) const
+{
+    while (!dirPath.empty() && (dirPath.back() == '*' || dirPath.back() == '/' || dirPath.back() == '\\')) {
+        dirPath.remove_suffix(1);
+    }
+    uint32_t id = kRoot;
+    size_t begin = 0;
+    while (begin < dirPath.size() && id != kNoNode) {
+        size_t end = dirPath.find_first_of("/\\", begin);
+        if (end == std::string_view::npos) end = dirPath.size();
+        if (end > begin) id = childOf(id, dirPath.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return id;
+}
+
+uint64_t AnimCategoryTree::countUnder(std::string_view dirPath) const
+{
+    const uint32_t id = find(dirPath);
+    return id != kNoNode ? m_nodes[id].totalFiles : 0;
+}
+
+std::string AnimCategoryTree::pathOf(uint32_t id) const
+{
+    std::vector<uint32_t> chain;
+    for (uint32_t n = id; n != kRoot && n != kNoNode; n = m_nodes[n].parent) chain.push_back(n);
+    std::string path;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (!path.empty()) path.push_back('/');
+        path += m_nodes[*it].name;
+    }
+    return path;
+}
+
+std::vector<std::pair<std::string, uint64_t>> AnimCategoryTree::histogram(uint32_t id, size_t column) const
+{
+    std::vector<std::pair<std::string, uint64_t>> values;
+    for (const std::pair<uint32_t, uint64_t>& entry : m_nodes[id].histograms[column]) {
+        values.emplace_back(m_valueNames[column][entry.first], entry.second);
+    }
+    std::sort(values.begin(), values.end(),
+              [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+                  if (a.second != b.second) return a.second > b.second;
+                  return a.first < b.first;
+              });
+    return values;
+}
+
+void AnimCategoryTree::printTree(std::ostream& out, uint32_t id, size_t maxDepth) const
+{
+    out << "\n【目录树】\n";
+    printTreeNode(out, id, maxDepth, 1);
+}
+
+void AnimCategoryTree::printTreeNode(std::ostream& out, uint32_t id, size_t maxDepth, size_t indent) const
+{
+    const Node& node = m_nodes[id];
+    const std::string label = (id == kRoot ? std::string("animations") : node.name) + "/";
+    const int width = std::max(1, 40 - static_cast<int>(indent * 2));
+    out << std::string(indent * 2, ' ') << std::left << std::setw(width) << label
+        << std::right << std::setw(8) << node.totalFiles << "\n";
+    if (maxDepth == 0) return;
+    for (uint32_t child : node.children) printTreeNode(out, child, maxDepth - 1, indent + 1);
+}
+
+void AnimCategoryTree::printNode(std::ostream& out, uint32_t id) const
+{
+    const Node& node = m_nodes[id];
+    out << "\n【目录 " << (id == kRoot ? std::string("animations") : pathOf(id)) << "】\n";
+    out << "  文件总数: " << node.totalFiles << "（本目录 " << node.files << "，子目录 " << node.children.size()
+        << " 个）\n";
+    for (size_t k = 0; k < m_columns.size(); ++k) {
+        out << "  " << statColumnTitle(m_columns[k]) << ":";
+        const std::vector<std::pair<std::string, uint64_t>> values = histogram(id, k);
+        for (size_t v = 0; v < values.size(); ++v) {
+            out << (v > 0 ? ", " : " ") << values[v].first << " " << values[v].second;
+        }
+        out << "\n";
+    }
+}
+
+void AnimCategoryTree::writeCsv(std::ostream& out, uint32_t id, size_t maxDepth) const
+{
+    out << "路径,深度,本目录文件数,文件总数\n";
+    writeCsvNode(out, id, maxDepth);
+}
+
+void AnimCategoryTree::writeCsvNode(std::ostream& out, uint32_t id, size_t maxDepth) const
+{
+    const Node& node = m_nodes[id];
+    out << escapeCSV(pathOf(id)) << ',' << node.depth << ',' << node.files << ',' << node.totalFiles << '\n';
+    if (maxDepth == 0) return;
+    for (uint32_t child : node.children) writeCsvNode(out, child, maxDepth - 1);
+}
+
+void AnimCategoryTree::writeJson(std::ostream& out, uint32_t id, size_t maxDepth) const
+{
+    writeJsonNode(out, id, maxDepth);
+    out << "\n";
+}
+
+void AnimCategoryTree::writeJsonNode(std::ostream& out, uint32_t id, size_t maxDepth) const
+{
+    const Node& node = m_nodes[id];
+    out << "{\"name\":\"" << json_escape(node.name) << "\",\"path\":\"" << json_escape(pathOf(id))
+        << "\",\"depth\":" << node.depth << ",\"files\":" << node.files << ",\"total\":" << node.totalFiles
+        << ",\"histograms\":{";
+    for (size_t k = 0; k < m_columns.size(); ++k) {
+        if (k > 0) out << ',';
+        out << '"' << statColumnName(m_columns[k]) << "\":{";
+        const std::vector<std::pair<std::string, uint64_t>> values = histogram(id, k);
+        for (size_t v = 0; v < values.size(); ++v) {
+            if (v > 0) out << ',';
+            out << '"' << json_escape(values[v].first) << "\":" << values[v].second;
+        }
+        out << '}';
+    }
+    out << "},\"children\":[";
+    if (maxDepth > 0) {
+        for (size_t c = 0; c < node.children.size(); ++c) {
+            if (c > 0) out << ',';
+            writeJsonNode(out, node.children[c], maxDepth - 1);
+        }
+    }
+    out << "]}";
+}
+
+void AnimCategoryTree::write(std::ostream& out, AnimStatsFormat format, uint32_t id, size_t maxDepth) const
+{
+    switch (format) {
+    case AnimStatsFormat::Console: printTree(out, id, maxDepth); break;
+    case AnimStatsFormat::Csv: writeCsv(out, id, maxDepth); break;
+    case AnimStatsFormat::Json: writeJson(out, id, maxDepth); break;
+    }
+}
@@ -0,0 +1,94 @@
+﻿#pragma once
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AnimStats.h"
+
+class CompactRowTable;
+struct CSVRow;
+
+// 相对路径的目录前缀树：每个节点是一级目录（根为 animations 目录本身），
+// 插入文件时沿父节点逐级累加文件数和各直方图列的值计数，因此任意子树的汇总只需 O(深度) 找到节点后直接读取
+class AnimCategoryTree
+{
+public:
+    static constexpr uint32_t kNoNode = 0xFFFFFFFFu;
+    static constexpr uint32_t kRoot = 0;
+    static constexpr size_t kUnlimitedDepth = std::numeric_limits<size_t>::max();
+
+    struct Node
+    {
+        std::string name;                  // 本级目录名，根为空
+        uint32_t parent;                   // 根为 kNoNode
+        uint32_t depth;                    // 根为 0，即目录层数（路径规整时与 getDepth 相同）
+        uint64_t files = 0;                // 直接位于该目录的文件数
+        uint64_t totalFiles = 0;           // 子树（含本目录）的文件数
+        std::vector<uint32_t> children;    // 按名称升序
+        // [直方图列] -> 按值ID升序的 (值ID, 子树中的文件数)；稀疏保存，叶子目录通常只有几个值
+        std::vector<std::vector<std::pair<uint32_t, uint64_t>>> histograms;
+    };
+
+    // histogram_columns 为每个节点汇总的分类列（多值列一个文件计入它的每个值）
+    explicit AnimCategoryTree(const std::vector<StatColumn>& histogram_columns = {
+                                  StatColumn::BodyType, StatColumn::ActionType, StatColumn::WeaponType});
+
+    void clear();
+    // 清空后按相对路径插入表中每一行
+    void build(const CompactRowTable& table);
+    void build(const std::vector<CSVRow>& rows);
+
+    // dirPath 形如 "quest/main_quests"，末尾的 "/" 或 "/*" 可以省略，空串为根；
+    // 逐级在子节点中二分查找，不存在时返回 kNoNode
+    uint32_t find(std::string_view dirPath) const;
+    // 目录下（含所有子目录）的文件数，目录不存在时为 0
+    uint64_t countUnder(std::string_view dirPath) const;
+
+    const Node& node(uint32_t id) const { return m_nodes[id]; }
+    size_t nodeCount() const { return m_nodes.size(); }
+    std::string pathOf(uint32_t id) const;
+
+    const std::vector<StatColumn>& histogramColumns() const { return m_columns; }
+    // 子树中第 column 个直方图列各值的文件数，按数量降序、数量相同时按值升序
+    std::vector<std::pair<std::string, uint64_t>> histogram(uint32_t id, size_t column) const;
+
+    // 控制台：按层缩进输出 id 下 maxDepth 层以内的目录及文件总数
+    void printTree(std::ostream& out, uint32_t id = kRoot, size_t maxDepth = kUnlimitedDepth) const;
+    // 控制台：一个目录的文件数和各直方图
+    void printNode(std::ostream& out, uint32_t id) const;
+    // CSV：每个目录一行（路径、深度、本目录文件数、文件总数）
+    void writeCsv(std::ostream& out, uint32_t id = kRoot, size_t maxDepth = kUnlimitedDepth) const;
+    // JSON：嵌套的目录摘要，每个节点带文件数、直方图和 children
+    void writeJson(std::ostream& out, uint32_t id = kRoot, size_t maxDepth = kUnlimitedDepth) const;
+    void write(std::ostream& out, AnimStatsFormat format, uint32_t id = kRoot,
+               size_t maxDepth = kUnlimitedDepth) const;
+
+private:
+    // 目录路径对应的节点，不存在的节点逐级创建；slash_only 为 false 时 '\' 也是分隔符，连续的分隔符不产生空目录
+    uint32_t nodeFor(std::string_view dir, bool slash_only);
+    uint32_t childFor(uint32_t parent, std::string_view name);
+    uint32_t childOf(uint32_t parent, std::string_view name) const;
+    // 一个文件计入 id 及其所有祖先；value_ids[k] 的前 counts[k] 项为第 k 列的值ID
+    void addFile(uint32_t id, const uint32_t* value_ids, const size_t* counts);
+    uint32_t internValue(size_t column, const std::string& value);
+
+    void writeJsonNode(std::ostream& out, uint32_t id, size_t maxDepth) const;
+    void writeCsvNode(std::ostream& out, uint32_t id, size_t maxDepth) const;
+    void printTreeNode(std::ostream& out, uint32_t id, size_t maxDepth, size_t indent) const;
+
+    std::vector<StatColumn> m_columns;
+    std::vector<Node> m_nodes;
+    // 每个直方图列的值字典
+    std::vector<std::vector<std::string>> m_valueNames;
+    std::vector<std::unordered_map<std::string, uint32_t>> m_valueIds;
+
+    // 连续的行大多在同一目录，记住上一行的目录节点
+    std::string m_lastDir;
+    bool m_lastSlashOnly = true;
+    uint32_t m_lastNode = kNoNode;
+};
@@ -1,29 +1,99 @@
 ﻿#include "AnimGroup.h"
+#include "AnimStats.h"
+#include "CompactRow.h"
+#include "DirClassCache.h"
+#include "WorkStealingPool.h"
 
-std::string escapeCSV(const std::string& field) {
-    // 检查是否包含需要转义的特殊字符：, " \n \r
-    bool needEscape = (field.find(',') != std::string::npos) ||
-                      (field.find('"') != std::string::npos) ||
-                      (field.find('\n') != std::string::npos) ||
-                      (field.find('\r') != std::string::npos);
+#include <charconv>
+#include <thread>
+
+namespace
+{
+    // 每块约 256KB 的行数据，正好放进 L2；块太小时任务调度开销占比过高
+    const size_t kClassifyChunkBytes = 256 * 1024;
+    const size_t kClassifyChunkRows = kClassifyChunkBytes / sizeof(CSVRow) > 0 ? kClassifyChunkBytes / sizeof(CSVRow) : 1;
+}
 
-    if (!needEscape) {
-        return field;  // 无特殊字符，直接返回
+void AnimsClassifier::classifyRow(CSVRow& row, uint32_t dirId, DirClassCache& cache)
+{
+    // 文件名含分隔符或不是完整路径的后缀时，无法保证相对路径的拆分与整条路径一致
+    const size_t nameLength = row.filename.size();
+    if (nameLength > row.fullpath.size() || row.filename.find_first_of("\\/") != std::string::npos ||
+        row.fullpath.compare(row.fullpath.size() - nameLength, nameLength, row.filename) != 0) {
+        classifyRow(row);
+        return;
     }
 
-    // 有特殊字符：用双引号包裹，且双引号转义为 ""
-    std::string escaped = "\"";  // 开头包裹符
-    for (char c : field) {
-        if (c == '"') {
-            escaped += "\"\"";  // 双引号转义（CSV 标准：" → ""）
-        } else {
-            escaped += c;
+    const std::string_view dirPart(row.fullpath.data(), row.fullpath.size() - nameLength);
+    const DirClassCache::Entry& dir = cache.lookup(*this, dirId, dirPart);
+    row.relativePath.assign(dir.relDir).append(row.filename);
+    row.topCategory = dir.topCategory;
+    row.subCategory = dir.subCategory;
+    // 从目录部分的自动机状态继续匹配文件名
+    AnimRuleMatcher::Hits hits = dir.hits;
+    matchRules(row.relativePath, hits, dir.relDir.size(), dir.state);
+    row.bodyType = formatRules(RuleGroup::Body, hits);
+    row.actionType = formatRules(RuleGroup::Action, hits);
+    row.sceneType = formatRules(RuleGroup::Scene, hits);
+    row.weaponType = formatRules(RuleGroup::Weapon, hits);
+    row.cyberwareType = formatRules(RuleGroup::Cyberware, hits);
+    row.characterPrefix = getCharacterPrefix(row.filename);
+    row.specialTags = formatRules(RuleGroup::Tag, hits);
+    row.depth = dir.depth;
+}
+
+void AnimsClassifier::classifyRows(CSVRow* rows, size_t count, size_t thread_count)
+{
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    // 不足两块或只有一个线程时直接逐行处理，省去创建线程池
+    if (thread_count <= 1 || count < 2 * kClassifyChunkRows) {
+        for (size_t i = 0; i < count; ++i) {
+            classifyRow(rows[i]);
         }
+        return;
     }
-    escaped += "\"";  // 结尾包裹符
+
+    WorkStealingPool pool(thread_count);
+    for (size_t begin = 0; begin < count; begin += kClassifyChunkRows) {
+        const size_t end = std::min(count, begin + kClassifyChunkRows);
+        pool.submit([this, rows, begin, end] {
+            for (size_t i = begin; i < end; ++i) {
+                classifyRow(rows[i]);
+            }
+        });
+    }
+    pool.wait();
+}
+
+std::string escapeCSV(const std::string& field) {
+    std::string escaped;
+    appendEscapedCSV(escaped, field);
     return escaped;
 }
 
+void appendEscapedCSV(std::string& out, std::string_view field)
+{
+    // 检查是否包含需要转义的特殊字符：, " \n \r
+    const size_t special = StringKernels::findAnyOf(field, ",\"\n\r");
+    if (special == std::string_view::npos) {
+        out.append(field.data(), field.size());  // 无特殊字符，直接复制
+        return;
+    }
+
+    // 有特殊字符：用双引号包裹，且双引号转义为 ""（复制到引号为止再补一个引号）
+    out.push_back('"');
+    size_t begin = 0;
+    for (size_t quote = field.find('"', special); quote != std::string_view::npos; quote = field.find('"', begin)) {
+        out.append(field.data() + begin, quote + 1 - begin);
+        out.push_back('"');
+        begin = quote + 1;
+    }
+    out.append(field.data() + begin, field.size() - begin);
+    out.push_back('"');
+}
+
 std::vector<std::string> parseCSVLine(const std::string& line)
  {                                                    
     std::vector<std::string> fields;                                                                                
@@ -52,57 +122,80 @@ std::vector<std::string> parseCSVLine(const std::string& line)
     return fields;                                                                                                  
 }
 
+const char* const kClassifiedCSVHeader =
+    "序号,文件名称,完整路径,相对路径,顶级分类,子分类,体型,动作类型,场景类型,武器类型,义体类型,角色前缀,特殊标签,深度";
+
+void writeClassifiedRow(std::ostream& out, const CSVRow& row)
+{
+    writeClassifiedFields(out, row);
+    out << '\n';
+}
+
+void writeClassifiedFields(std::ostream& out, const CSVRow& row)
+{
+    // 先拼成一行再整段写入，避免每个字段一次流操作
+    thread_local std::string line;
+    line.clear();
+    appendClassifiedFields(line, row);
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+void appendClassifiedFields(std::string& out, const CSVRow& row)
+{
+    const std::string* const fields[] = {
+        &row.index, &row.filename, &row.fullpath, &row.relativePath, &row.topCategory, &row.subCategory,
+        &row.bodyType, &row.actionType, &row.sceneType, &row.weaponType, &row.cyberwareType,
+        &row.characterPrefix, &row.specialTags,
+    };
+    for (const std::string* field : fields) {
+        appendEscapedCSV(out, *field);
+        out.push_back(',');
+    }
+    char digits[16];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), row.depth);
+    out.append(digits, result.ptr);
+}
+
+namespace
+{
+    void printCategoryCounts(const AnimStatsResult& topCategories, const AnimStatsResult& bodyTypes)
+    {
+        std::cout << "\n";
+        std::cout << "============================================================\n";
+        std::cout << "                     分类统计信息\n";
+        std::cout << "============================================================\n";
+
+        // 打印顶级分类
+        std::cout << "\n【顶级分类分布】\n";
+        for (const auto& group : topCategories.groups) {
+            std::cout << "  " << std::left << std::setw(25) << group.values[0]
+                      << ": " << std::right << std::setw(6) << group.count << "\n";
+        }
+
+        // 打印体型分类
+        if (!bodyTypes.groups.empty()) {
+            std::cout << "\n【角色体型分布】\n";
+            for (const auto& group : bodyTypes.groups) {
+                std::cout << "  " << std::left << std::setw(25) << group.values[0]
+                          << ": " << std::right << std::setw(6) << group.count << "\n";
+            }
+        }
+
+        std::cout << "\n";
+    }
+}
+
+// 两种输入都交给 AnimStatsEngine 分组计数（数量相同的分类按名称升序）
 void printStatistics(const std::vector<CSVRow>& rows)
- {                                                             
-    std::map<std::string, int> topCategories;                                                                       
-    std::map<std::string, int> bodyTypes;                                                                           
-                                                                                                                    
-    for (const auto& row : rows) {                                                                                  
-        if (!row.topCategory.empty()) {                                                                             
-            topCategories[row.topCategory]++;                                                                       
-        }                                                                                                           
-                                                                                                                    
-        if (!row.bodyType.empty()) {                                                                                
-            std::istringstream iss(row.bodyType);                                                                   
-            std::string token;                                                                                      
-            while (std::getline(iss, token, ';')) {                                                                 
-                token.erase(0, token.find_first_not_of(" "));                                                       
-                token.erase(token.find_last_not_of(" ") + 1);                                                       
-                if (!token.empty()) {                                                                               
-                    bodyTypes[token]++;                                                                             
-                }                                                                                                   
-            }                                                                                                       
-        }                                                                                                           
-    }                                                                                                               
-                                                                                                                    
-    std::cout << "\n";                                                                                              
-    std::cout << "============================================================\n";                                  
-    std::cout << "                     分类统计信息\n";                                                             
-    std::cout << "============================================================\n";                                  
-                                                                                                                    
-    // 打印顶级分类                                                                                                 
-    std::cout << "\n【顶级分类分布】\n";                                                                            
-    std::vector<std::pair<std::string, int>> topVec(topCategories.begin(), topCategories.end());                    
-    std::sort(topVec.begin(), topVec.end(),                                                                         
-              [](const auto& a, const auto& b) { return a.second > b.second; });                                    
-                                                                                                                    
-    for (const auto& [cat, count] : topVec) {                                                                       
-        std::cout << "  " << std::left << std::setw(25) << cat                                                      
-                  << ": " << std::right << std::setw(6) << count << "\n";                                           
-    }                                                                                                               
-                                                                                                                    
-    // 打印体型分类                                                                                                 
-    if (!bodyTypes.empty()) {                                                                                       
-        std::cout << "\n【角色体型分布】\n";                                                                        
-        std::vector<std::pair<std::string, int>> bodyVec(bodyTypes.begin(), bodyTypes.end());                       
-        std::sort(bodyVec.begin(), bodyVec.end(),                                                                   
-                  [](const auto& a, const auto& b) { return a.second > b.second; });                                
-                                                                                                                    
-        for (const auto& [body, count] : bodyVec) {                                                                 
-            std::cout << "  " << std::left << std::setw(25) << body                                                 
-                      << ": " << std::right << std::setw(6) << count << "\n";                                       
-        }                                                                                                           
-    }                                                                                                               
-                                                                                                                    
-    std::cout << "\n";                                                                                              
-}               
\ No newline at end of file
+{
+    AnimStatsEngine engine;
+    printCategoryCounts(engine.groupBy(rows, {StatColumn::TopCategory}),
+                        engine.groupBy(rows, {StatColumn::BodyType}));
+}
+
+void printStatistics(const CompactRowTable& table)
+{
+    AnimStatsEngine engine;
+    printCategoryCounts(engine.groupBy(table, {StatColumn::TopCategory}),
+                        engine.groupBy(table, {StatColumn::BodyType}));
+}
\ No newline at end of file
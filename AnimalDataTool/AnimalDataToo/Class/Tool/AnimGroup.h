@@ -5,12 +5,19 @@
 #include <string>                                                                                                   
 #include <vector>                                                                                                   
 #include <map>                                                                                                      
-#include <regex>                                                                                                    
+#include <string_view>
+#include <memory>
 #include <algorithm>                                                                                                
 #include <codecvt>                                                                                                  
 #include <iomanip>
-#include <locale>                                                                                                   
-                                                                                                                    
+#include <locale>
+
+#include "AnimBuiltinRules.h"
+#include "AnimRuleMatcher.h"
+#include "StringKernels.h"
+
+class DirClassCache;
+
 // CSV行数据结构                                                                                                    
 struct CSVRow {                                                                                                     
     std::string index;                                                                                              
@@ -31,92 +38,51 @@ struct CSVRow {
     int depth;                                                                                                      
 };                                                                                                                  
                                                                                                                     
-class AnimsClassifier {                                                                                             
-private:                                                                                                            
-    // 分类规则映射                                                                                                 
-    std::map<std::string, std::regex> bodyTypePatterns;                                                             
-    std::map<std::string, std::regex> actionPatterns;                                                               
-    std::map<std::string, std::regex> scenePatterns;                                                                
-    std::vector<std::string> weaponTypes;                                                                           
-    std::vector<std::string> cyberwareTypes;                                                                        
-    std::map<std::string, std::string> characterPrefixes;                                                           
-                                                                                                                    
-public:                                                                                                             
-    AnimsClassifier() {                                                                                             
-        initializePatterns();                                                                                       
-    }                                                                                                               
-                                                                                                                    
-    void initializePatterns() {                                                                                     
-        // 体型分类模式                                                                                             
-        bodyTypePatterns["male_average"] = std::regex("male_average|man_average", std::regex::icase);               
-        bodyTypePatterns["female_average"] = std::regex("female_average|woman_average", std::regex::icase);         
-        bodyTypePatterns["male_big"] = std::regex("male_big|man_big", std::regex::icase);                           
-        bodyTypePatterns["male_fat"] = std::regex("male_fat|man_fat", std::regex::icase);                           
-        bodyTypePatterns["male_massive"] = std::regex("male_massive|man_massive", std::regex::icase);               
-        bodyTypePatterns["male_child"] = std::regex("male_child|child_male|boy", std::regex::icase);                
-        bodyTypePatterns["female_child"] = std::regex("female_child|child_female|girl", std::regex::icase);         
-        bodyTypePatterns["female_chubby"] = std::regex("female_chubby|woman_chubby", std::regex::icase);            
-                                                                                                                    
-        // 动作类型模式                                                                                             
-        actionPatterns["stand"] = std::regex("\\bstand", std::regex::icase);                                        
-        actionPatterns["sit"] = std::regex("\\bsit", std::regex::icase);                                            
-        actionPatterns["walk"] = std::regex("\\bwalk", std::regex::icase);                                          
-        actionPatterns["run"] = std::regex("\\brun", std::regex::icase);                                            
-        actionPatterns["idle"] = std::regex("\\bidle", std::regex::icase);                                          
-        actionPatterns["combat"] = std::regex("\\bcombat", std::regex::icase);                                      
-        actionPatterns["attack"] = std::regex("\\battack", std::regex::icase);                                      
-        actionPatterns["takedown"] = std::regex("\\btakedown", std::regex::icase);                                  
-        actionPatterns["finisher"] = std::regex("\\bfinisher", std::regex::icase);                                  
-        actionPatterns["lean"] = std::regex("\\blean", std::regex::icase);                                          
-        actionPatterns["lie"] = std::regex("\\blie", std::regex::icase);                                            
-        actionPatterns["kneel"] = std::regex("\\bkneel", std::regex::icase);                                        
-        actionPatterns["crouch"] = std::regex("\\bcrouch", std::regex::icase);                                      
-                                                                                                                    
-        // 场景类型模式                                                                                             
-        scenePatterns["interactive_scene"] = std::regex("interactive_scene", std::regex::icase);                    
-        scenePatterns["open_world"] = std::regex("open_world", std::regex::icase);                                  
-        scenePatterns["gameplay"] = std::regex("gameplay", std::regex::icase);                                      
-        scenePatterns["cutscene"] = std::regex("cutscene", std::regex::icase);                                      
-                                                                                                                    
-        // 武器类型                                                                                                 
-        weaponTypes = {                                                                                             
-            "handgun", "revolver", "smg", "rifle_assault", "rifle_precision",                                       
-            "rifle_sniper", "shotgun", "lmg", "katana", "knife", "baton",                                           
-            "melee_fists", "one_handed_blunt", "two_handed_blunt"                                                   
-        };                                                                                                          
-                                                                                                                    
-        // 义体类型                                                                                                 
-        cyberwareTypes = {                                                                                          
-            "mantisblade", "monowire", "launcher", "strongarms",                                                    
-            "personal_link", "armshield", "jammer"                                                                  
-        };                                                                                                          
-                                                                                                                    
-        // 角色前缀                                                                                                 
-        characterPrefixes["pma"] = "Player_Male_Average";                                                           
-        characterPrefixes["pwa"] = "Player_Female_Average";                                                         
-        characterPrefixes["cw"] = "Cyberware";                                                                      
-        characterPrefixes["ma"] = "Male_Average";                                                                   
-        characterPrefixes["wa"] = "Female_Average";                                                                 
-        characterPrefixes["face"] = "Facial";                                                                       
-    }                                                                                                               
-                                                                                                                    
-    // 提取相对路径                                                                                                 
-    std::string extractRelativePath(const std::string& fullPath) {                                                  
-        size_t pos = fullPath.find("\\animations\\");                                                               
-        if (pos == std::string::npos) {                                                                             
-            pos = fullPath.find("/animations/");                                                                    
-        }                                                                                                           
-                                                                                                                    
-        if (pos != std::string::npos) {                                                                             
-            std::string relative = fullPath.substr(pos + 12); // 跳过 "animations\"                                 
-            std::replace(relative.begin(), relative.end(), '\\', '/');                                              
-            return relative;                                                                                        
-        }                                                                                                           
-        return fullPath;                                                                                            
-    }                                                                                                               
+class AnimsClassifier {
+private:
+    // 通过 loadRules 加载的自定义规则；为空时使用编译期生成的内置规则（BuiltinAnimRules）。
+    // 规则加载后不再修改，复制的分类器共享同一份
+    std::shared_ptr<const AnimRuleMatcher> customRules;
+
+public:
+    // 内置规则在编译期生成，构造时无需初始化
+    AnimsClassifier() {
+    }
+
+    // 恢复内置规则
+    void initializePatterns() {
+        customRules.reset();
+    }
+                                                                                                                    
+    // 相对路径（"animations" 目录之后）在完整路径中的起点，没有 animations 目录时返回 npos。
+    // 优先 "\animations\"，没有时才用 "/animations/"：只扫描一遍 "animations"，再看两侧的分隔符
+    static size_t relativePathOffset(std::string_view fullPath) {
+        size_t slash = std::string_view::npos;
+        size_t pos = StringKernels::find(fullPath, "animations", 1);
+        while (pos != std::string_view::npos && pos + 10 < fullPath.size()) {
+            const char before = fullPath[pos - 1];
+            if (before == fullPath[pos + 10]) {
+                if (before == '\\') return pos + 11;
+                if (before == '/' && slash == std::string_view::npos) slash = pos + 11;
+            }
+            pos = StringKernels::find(fullPath, "animations", pos + 1);
+        }
+        return slash;
+    }
+
+    // 提取相对路径
+    std::string extractRelativePath(const std::string& fullPath) const {
+        const size_t offset = relativePathOffset(fullPath);
+        if (offset != std::string_view::npos) {
+            std::string relative = fullPath.substr(offset);
+            StringKernels::replaceByte(&relative[0], relative.size(), '\\', '/');
+            return relative;
+        }
+        return fullPath;
+    }
                                                                                                                     
     // 获取顶级分类                                                                                                 
-    std::string getTopCategory(const std::string& relPath) {                                                        
+    std::string getTopCategory(const std::string& relPath) const {                                                        
         size_t pos = relPath.find('/');                                                                             
         if (pos != std::string::npos) {                                                                             
             return relPath.substr(0, pos);                                                                          
@@ -125,7 +91,7 @@ public:
     }                                                                                                               
                                                                                                                     
     // 获取子分类                                                                                                   
-    std::string getSubCategory(const std::string& relPath) {                                                        
+    std::string getSubCategory(const std::string& relPath) const {                                                        
         size_t pos1 = relPath.find('/');                                                                            
         if (pos1 != std::string::npos) {                                                                            
             size_t pos2 = relPath.find('/', pos1 + 1);                                                              
@@ -136,119 +102,90 @@ public:
         return "";                                                                                                  
     }                                                                                                               
                                                                                                                     
-    // 根据模式分类                                                                                                 
-    std::string classifyByPatterns(const std::string& path,                                                         
-                                   const std::map<std::string, std::regex>& patterns) {                             
-        std::vector<std::string> matches;                                                                           
-        for (const auto& [name, pattern] : patterns) {                                                              
-            if (std::regex_search(path, pattern)) {                                                                 
-                matches.push_back(name);                                                                            
-            }                                                                                                       
-        }                                                                                                           
-                                                                                                                    
-        if (matches.empty()) return "";                                                                             
-                                                                                                                    
-        std::string result;                                                                                         
-        for (size_t i = 0; i < matches.size(); ++i) {                                                               
-            if (i > 0) result += "; ";                                                                              
-            result += matches[i];                                                                                   
-        }                                                                                                           
-        return result;                                                                                              
-    }                                                                                                               
-                                                                                                                    
-    // 分类武器类型                                                                                                 
-    std::string classifyWeaponType(const std::string& path) {                                                       
-        std::string lowerPath = path;                                                                               
-        std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);                           
-                                                                                                                    
-        for (const auto& weapon : weaponTypes) {                                                                    
-            if (lowerPath.find(weapon) != std::string::npos) {                                                      
-                return weapon;                                                                                      
-            }                                                                                                       
-        }                                                                                                           
-        return "";                                                                                                  
-    }                                                                                                               
-                                                                                                                    
-    // 分类义体类型                                                                                                 
-    std::string classifyCyberwareType(const std::string& path) {                                                    
-        std::string lowerPath = path;                                                                               
-        std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);                           
-                                                                                                                    
-        for (const auto& cyber : cyberwareTypes) {                                                                  
-            if (lowerPath.find(cyber) != std::string::npos) {                                                       
-                return cyber;                                                                                       
-            }                                                                                                       
-        }                                                                                                           
-        return "";                                                                                                  
-    }                                                                                                               
-                                                                                                                    
-    // 获取角色前缀                                                                                                 
-    std::string getCharacterPrefix(const std::string& filename) {                                                   
-        std::string lowerName = filename;                                                                           
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);                           
-                                                                                                                    
-        for (const auto& [prefix, meaning] : characterPrefixes) {                                                   
-            if (lowerName.find(prefix + "_") == 0) {                                                                
-                return meaning;                                                                                     
-            }                                                                                                       
-        }                                                                                                           
-        return "";                                                                                                  
-    }                                                                                                               
-                                                                                                                    
-    // 获取特殊标签                                                                                                 
-    std::string getSpecialTags(const std::string& path) {                                                           
-        std::vector<std::string> tags;                                                                              
-        std::string lowerPath = path;                                                                               
-        std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), ::tolower);                           
-                                                                                                                    
-        if (lowerPath.find("facial") != std::string::npos ||                                                        
-            lowerPath.find("face_") != std::string::npos) {                                                         
-            tags.push_back("Facial");                                                                               
-        }                                                                                                           
-        if (lowerPath.find("sync") != std::string::npos) {                                                          
-            tags.push_back("Sync");                                                                                 
-        }                                                                                                           
-        if (lowerPath.find("finisher") != std::string::npos) {                                                      
-            tags.push_back("Finisher");                                                                             
-        }                                                                                                           
-        if (lowerPath.find("takedown") != std::string::npos) {                                                      
-            tags.push_back("Takedown");                                                                             
-        }                                                                                                           
-        if (lowerPath.find("transition") != std::string::npos) {                                                    
-            tags.push_back("Transition");                                                                           
-        }                                                                                                           
-        if (lowerPath.find("fpp") != std::string::npos) {                                                           
-            tags.push_back("FPP");                                                                                  
-        }                                                                                                           
-        if (lowerPath.find("tpp") != std::string::npos) {                                                           
-            tags.push_back("TPP");                                                                                  
-        }                                                                                                           
-        if (lowerPath.find("work") != std::string::npos) {                                                          
-            tags.push_back("Work");                                                                                 
-        }                                                                                                           
-        if (lowerPath.find("gesture") != std::string::npos) {                                                       
-            tags.push_back("Gesture");                                                                              
-        }                                                                                                           
-        if (lowerPath.find("idle") != std::string::npos) {                                                          
-            tags.push_back("Idle");                                                                                 
-        }                                                                                                           
-        if (lowerPath.find("combat") != std::string::npos) {                                                        
-            tags.push_back("Combat");                                                                               
-        }                                                                                                           
-                                                                                                                    
-        if (tags.empty()) return "";                                                                                
-                                                                                                                    
-        std::string result;                                                                                         
-        for (size_t i = 0; i < tags.size(); ++i) {                                                                  
-            if (i > 0) result += "; ";                                                                              
-            result += tags[i];                                                                                      
-        }                                                                                                           
-        return result;                                                                                              
-    }                                                                                                               
-                                                                                                                    
+    // 从规则文件加载体型/动作/场景/武器/义体/特殊标签规则，替换内置规则；失败时保留原规则
+    bool loadRules(const std::string& rulesPath) {
+        std::shared_ptr<AnimRuleMatcher> loaded = std::make_shared<AnimRuleMatcher>();
+        if (!loaded->loadRulesFile(rulesPath)) {
+            return false;
+        }
+        customRules = loaded;
+        return true;
+    }
+
+    // 导出当前规则（可作为自定义规则文件的模板）
+    bool saveRules(const std::string& rulesPath) const {
+        if (customRules) {
+            return customRules->saveRulesFile(rulesPath);
+        }
+        AnimRuleMatcher builtin;
+        BuiltinAnimRules::addTo(builtin);
+        return builtin.saveRulesFile(rulesPath);
+    }
+
+    // 一次扫描得到所有规则组的命中结果（位序号见 ruleName）；from/state 用于从前缀的匹配状态继续，见 AnimRuleMatcher::match
+    size_t matchRules(std::string_view path, AnimRuleMatcher::Hits& hits, size_t from = 0, size_t state = 0) const {
+        if (customRules) {
+            return customRules->match(path, hits, from, state);
+        }
+        return BuiltinAnimRules::match(path, hits, from, state);
+    }
+
+    // 当前生效的自定义规则，使用内置规则时为 nullptr（规则不同则自动机状态不可互用）
+    const std::shared_ptr<const AnimRuleMatcher>& activeRules() const {
+        return customRules;
+    }
+
+    std::string formatRules(RuleGroup group, const AnimRuleMatcher::Hits& hits) const {
+        return customRules ? customRules->format(group, hits) : BuiltinAnimRules::format(group, hits);
+    }
+
+    size_t ruleCount(RuleGroup group) const {
+        return customRules ? customRules->categoryCount(group) : BuiltinAnimRules::categoryCount(group);
+    }
+
+    std::string ruleName(RuleGroup group, size_t bit) const {
+        return customRules ? customRules->categoryName(group, bit) : BuiltinAnimRules::categoryName(group, bit);
+    }
+
+    // 根据模式分类
+    std::string classifyByPatterns(const std::string& path, RuleGroup group) {
+        AnimRuleMatcher::Hits hits;
+        matchRules(path, hits);
+        return formatRules(group, hits);
+    }
+
+    // 分类武器类型
+    std::string classifyWeaponType(const std::string& path) {
+        return classifyByPatterns(path, RuleGroup::Weapon);
+    }
+
+    // 分类义体类型
+    std::string classifyCyberwareType(const std::string& path) {
+        return classifyByPatterns(path, RuleGroup::Cyberware);
+    }
+
+    // 获取角色前缀
+    std::string getCharacterPrefix(const std::string& filename) {
+        int index = findCharacterPrefix(filename);
+        if (index < 0) {
+            return "";
+        }
+        return BuiltinAnimRules::characterPrefixName(index);
+    }
+
+    // 文件名（不区分大小写）以 "前缀_" 开头时返回前缀序号（见 BuiltinAnimRules::characterPrefixName），否则返回 -1
+    int findCharacterPrefix(std::string_view filename) const {
+        return BuiltinAnimRules::characterPrefix(filename);
+    }
+
+    // 获取特殊标签
+    std::string getSpecialTags(const std::string& path) {
+        return classifyByPatterns(path, RuleGroup::Tag);
+    }
+
     // 获取目录深度                                                                                                 
-    int getDepth(const std::string& relPath) {                                                                      
-        return std::count(relPath.begin(), relPath.end(), '/');                                                     
+    int getDepth(const std::string& relPath) const {                                                                      
+        return static_cast<int>(StringKernels::countByte(relPath, '/'));
     }                                                                                                               
                                                                                                                     
     // 对一行数据进行分类                                                                                           
@@ -256,20 +193,49 @@ public:
         row.relativePath = extractRelativePath(row.fullpath);                                                       
         row.topCategory = getTopCategory(row.relativePath);                                                         
         row.subCategory = getSubCategory(row.relativePath);                                                         
-        row.bodyType = classifyByPatterns(row.relativePath, bodyTypePatterns);                                      
-        row.actionType = classifyByPatterns(row.relativePath, actionPatterns);                                      
-        row.sceneType = classifyByPatterns(row.relativePath, scenePatterns);                                        
-        row.weaponType = classifyWeaponType(row.relativePath);                                                      
-        row.cyberwareType = classifyCyberwareType(row.relativePath);                                                
-        row.characterPrefix = getCharacterPrefix(row.filename);                                                     
-        row.specialTags = getSpecialTags(row.relativePath);                                                         
+        // 一次扫描得到所有规则组的命中结果
+        AnimRuleMatcher::Hits hits;
+        matchRules(row.relativePath, hits);
+        row.bodyType = formatRules(RuleGroup::Body, hits);
+        row.actionType = formatRules(RuleGroup::Action, hits);
+        row.sceneType = formatRules(RuleGroup::Scene, hits);
+        row.weaponType = formatRules(RuleGroup::Weapon, hits);
+        row.cyberwareType = formatRules(RuleGroup::Cyberware, hits);
+        row.characterPrefix = getCharacterPrefix(row.filename);
+        row.specialTags = formatRules(RuleGroup::Tag, hits);
         row.depth = getDepth(row.relativePath);                                                                     
     }                                                                                                               
+
+    // 按目录缓存分类：同一目录下的文件复用目录部分的分类结果和自动机状态，只匹配文件名。
+    // dirId 相同的文件必须位于同一目录（缓存会校验目录文本，不一致时重新计算），结果与 classifyRow(row) 完全相同
+    void classifyRow(CSVRow& row, uint32_t dirId, DirClassCache& cache);
+
+    // 批量分类：按缓存大小分块交给线程池并行处理。每行的结果只依赖该行本身，
+    // 与逐行调用 classifyRow 完全相同；分类过程不修改分类器。thread_count 为 0 时使用硬件线程数
+    void classifyRows(CSVRow* rows, size_t count, size_t thread_count = 0);
+    void classifyRows(std::vector<CSVRow>& rows, size_t thread_count = 0) {
+        classifyRows(rows.data(), rows.size(), thread_count);
+    }
 };                                                                                                                  
                                                                                                                     
 // CSV工具函数                                                                                                      
 std::string escapeCSV(const std::string& field);                                                                                                                   
+// 按 escapeCSV 的规则把字段追加到 out 末尾：只扫描一遍，两个引号之间的内容整段复制
+void appendEscapedCSV(std::string& out, std::string_view field);
                                                                                                                     
 std::vector<std::string> parseCSVLine(const std::string& line);                                                                                                         
-                                                                                                                    
-void printStatistics(const std::vector<CSVRow>& rows);
\ No newline at end of file
+
+// 分类结果 CSV：表头与单行输出（行尾为 '\n'，不刷新流）
+extern const char* const kClassifiedCSVHeader;
+
+void writeClassifiedRow(std::ostream& out, const CSVRow& row);
+// 只输出各列，不含行尾（用于在分类列之后追加其他列）
+void writeClassifiedFields(std::ostream& out, const CSVRow& row);
+// 与 writeClassifiedFields 输出相同，追加到 out 末尾（CsvWriter 直接格式化到写出缓冲区）
+void appendClassifiedFields(std::string& out, const CSVRow& row);
+                                                                                                                    
+void printStatistics(const std::vector<CSVRow>& rows);
+
+// 紧凑分类结果的统计：直接按分类ID和体型位计数，输出与 vector<CSVRow> 版本相同
+class CompactRowTable;
+void printStatistics(const CompactRowTable& table);
\ No newline at end of file
@@ -1,38 +1,612 @@
 ﻿#include "AnimGroupMethod.h"
 
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 
+#include "AnimCategoryTree.h"
+#include "AnimGroup.h"
+#include "AnimMetadata.h"
+#include "AnimNameCluster.h"
+#include "AnimPipeline.h"
+#include "AnimStats.h"
+#include "ArchiveIndex.h"
+#include "CompactRow.h"
+#include "ContentHasher.h"
+#include "CsvReader.h"
 #include "FindAnim.h"
+#include "PathTable.h"
+#include "ScanManifest.h"
+#include "ScanStats.h"
+#include "WorkStealingPool.h"
 #include "WriteTool.h"
 
+namespace
+{
+    // 加载 CSV 旁边的扫描清单做增量遍历，结束后写回清单
+    std::vector<std::string> find_files_incremental(FindAnim& find_anim, const std::string& folder,
+                                                    const std::string& csv_output_path)
+    {
+        const std::string manifest_path = ScanManifest::path_for_csv(csv_output_path);
+        ScanManifest manifest;
+        manifest.load(manifest_path);
+        std::vector<std::string> files = find_anim.find_animal_files_incremental(folder, manifest);
+        if (manifest.size() > 0) {
+            manifest.save(manifest_path);
+        }
+        return files;
+    }
+
+    // 去掉目录末尾的分隔符，便于做前缀比较
+    std::string trim_trailing_separator(std::string folder)
+    {
+        while (folder.size() > 1 && (folder.back() == '\\' || folder.back() == '/')) {
+            folder.pop_back();
+        }
+        return folder;
+    }
+
+    // path 是否位于 folder 目录之下（folder 已去掉末尾分隔符）
+    bool is_under_folder(const std::string& path, const std::string& folder)
+    {
+        return path.size() > folder.size() &&
+               (path[folder.size()] == '\\' || path[folder.size()] == '/') &&
+               path.compare(0, folder.size(), folder) == 0;
+    }
+
+    // 分类 CSV（kClassifiedCSVHeader）的列数；前三列为 序号、文件名称、完整路径，其余为分类结果
+    constexpr size_t kClassifiedColumnCount = 14;
+    constexpr size_t kFirstClassColumn = 3;
+
+    // 一块记录的重新分类结果，最后按块的顺序合并
+    struct ReclassifyChunk
+    {
+        size_t rows = 0;
+        size_t skipped = 0;
+        size_t column_changes[kClassifiedColumnCount] = {};
+        std::vector<CSVRow> changed;
+        std::vector<std::string> changes;
+    };
+
+    void reclassify_chunk(const CsvReader& reader, const CsvReader::Chunk& chunk, AnimsClassifier& classifier,
+                          const std::vector<std::string>& titles, ReclassifyChunk& result)
+    {
+        CsvReader::Cursor cursor = reader.rows(chunk);
+        CsvRow fields;
+        CSVRow row;
+        std::string change;
+        while (cursor.next(fields)) {
+            if (fields.size() < kClassifiedColumnCount) {
+                if (!fields.text().empty()) ++result.skipped;  // 空行不计
+                continue;
+            }
+            ++result.rows;
+            row.index.assign(fields[0]);
+            row.filename.assign(fields[1]);
+            row.fullpath.assign(fields[2]);
+            classifier.classifyRow(row);
+
+            const std::string* const current[] = {
+                &row.relativePath, &row.topCategory, &row.subCategory, &row.bodyType, &row.actionType,
+                &row.sceneType, &row.weaponType, &row.cyberwareType, &row.characterPrefix, &row.specialTags,
+            };
+            char digits[16];
+            const std::string_view depth(digits, std::to_chars(digits, digits + sizeof(digits), row.depth).ptr - digits);
+
+            // 变化列写成 "列名: 旧值 -> 新值"
+            change.clear();
+            for (size_t column = kFirstClassColumn; column < kClassifiedColumnCount; ++column) {
+                const std::string_view now =
+                    column + 1 < kClassifiedColumnCount ? std::string_view(*current[column - kFirstClassColumn]) : depth;
+                if (fields[column] == now) continue;
+                ++result.column_changes[column];
+                if (!change.empty()) change += "; ";
+                change.append(titles[column]).append(": ").append(fields[column]).append(" -> ").append(now);
+            }
+            if (!change.empty()) {
+                result.changed.push_back(row);
+                result.changes.push_back(change);
+            }
+        }
+    }
+
+    // 重新分类差异报告的默认路径：xxx.csv -> xxx_reclassified.csv
+    std::string reclassify_path_for_csv(const std::string& csv_path)
+    {
+        std::filesystem::path path(csv_path);
+        std::filesystem::path report = path;
+        report.replace_filename(path.stem().string() + "_reclassified.csv");
+        return report.string();
+    }
+
+    // 写出成功后把 CSV 文件大小计入当前线程的写出字节数
+    void record_bytes_written(ScanStats* stats, const std::string& csv_output_path)
+    {
+        if (!stats) return;
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(csv_output_path, ec);
+        if (!ec) ScanCounters::add(stats->local().bytes_written, size);
+    }
+}
+
 AnimGroupMethod::AnimGroupMethod()
+    : m_statsFormat(ScanStatsFormat::Json)
+{
+}
+
+AnimGroupMethod::~AnimGroupMethod()
 {
+    delete m_stats;
+}
+
+void AnimGroupMethod::EnableScanStats(ScanStatsFormat format, unsigned interval_seconds)
+{
+    m_statsEnabled = true;
+    m_statsFormat = format;
+    m_statsInterval = interval_seconds;
+}
+
+void AnimGroupMethod::SetScanFilter(const ScanFilter* filter)
+{
+    m_filter = filter;
+}
+
+void AnimGroupMethod::SetClassifier(const AnimsClassifier* classifier)
+{
+    m_classifier = classifier;
+}
+
+AnimsClassifier AnimGroupMethod::MakeClassifier() const
+{
+    return m_classifier ? *m_classifier : AnimsClassifier();
+}
+
+void AnimGroupMethod::BeginScanStats()
+{
+    delete m_stats;
+    m_stats = nullptr;
+    if (!m_statsEnabled) return;
+    m_stats = new ScanStats;
+    m_stats->start_periodic_dump(std::cout, m_statsFormat, m_statsInterval);
+}
+
+void AnimGroupMethod::EndScanStats()
+{
+    if (!m_stats) return;
+    m_stats->stop_periodic_dump();
+    std::cout << "\n【扫描统计】" << std::endl;
+    m_stats->write(std::cout, m_statsFormat);
+    delete m_stats;
+    m_stats = nullptr;
 }
 
 void AnimGroupMethod::AnimSCVCreate(std::string Infolder, bool recursive,std::string csv_output_path)
 {
+    BeginScanStats();
     FindAnim* find_anim=new FindAnim;
-    std::vector<std::string> files =find_anim-> find_animal_files(Infolder,recursive);
+    find_anim->set_filter(m_filter);
+    find_anim->set_stats(m_stats);
+    // 结果存入前缀压缩的路径表，完整路径只在打印/写出时拼接
+    PathTable table;
+    {
+        ScanStageTimer timer(m_stats, "walk");
+        find_anim->find_animal_files_table(Infolder, recursive, table);
+    }
     // 若需递归查找子目录，调用：find_animal_files(folder, true)
     delete find_anim;  // 释放内存
-    
+
+    WriteResult(table, csv_output_path);
+    EndScanStats();
+}
+
+void AnimGroupMethod::AnimSCVCreatePipelined(const std::string& Infolder, bool recursive,
+                                             const std::string& csv_output_path)
+{
+    BeginScanStats();
+    AnimPipeline pipeline(m_classifier);
+    pipeline.set_filter(m_filter);
+    pipeline.set_scan_stats(m_stats);
+    bool write_success = pipeline.run(Infolder, recursive, csv_output_path);
+    pipeline.print_stats(std::cout);
+    if (write_success) {
+        record_bytes_written(m_stats, csv_output_path);
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+    EndScanStats();
+}
+
+void AnimGroupMethod::AnimSCVCreateFromArchives(const std::string& archive_folder, const std::string& hash_list_path,
+                                                const std::string& csv_output_path)
+{
+    ArchiveIndex archive_index;
+    if (archive_index.load_hash_list(hash_list_path) == 0) {
+        std::cerr << "警告：哈希列表为空，无法还原 .anims 路径" << std::endl;
+        return;
+    }
+    archive_index.index_folder(archive_folder);
+    std::vector<std::string> paths = archive_index.sorted_paths();
+    if (m_filter) {
+        // glob 与目录扫描一样相对 animations 目录匹配（没有 animations 目录时为整个仓库路径）
+        paths.erase(std::remove_if(paths.begin(), paths.end(), [this](const std::string& path) {
+            const size_t offset = AnimsClassifier::relativePathOffset(path);
+            return !m_filter->accept_path(std::string_view(path).substr(offset == std::string_view::npos ? 0 : offset));
+        }), paths.end());
+    }
+    std::cout << "找到 " << paths.size() << " 个 .Animal 文件（" << archive_index.unresolved_count()
+              << " 个条目不在哈希列表中）" << std::endl;
+
+    // 仓库路径使用反斜杠分隔，与解包后的目录结构一致，分类规则无需区分来源
+    // 分类结果保存为紧凑行，路径集中存放，分类列在写出时才还原为字符串
+    AnimsClassifier classifier = MakeClassifier();
+    CompactRowTable rows(classifier);
+    size_t path_bytes = 0;
+    for (const std::string& path : paths) {
+        path_bytes += path.size();
+    }
+    rows.reserve(paths.size(), path_bytes);
+    for (std::string& path : paths) {
+        size_t slash = path.find_last_of("\\/");
+        std::string_view filename(path);
+        if (slash != std::string::npos) {
+            filename.remove_prefix(slash + 1);
+        }
+        // 同一目录下的文件复用目录部分的分类结果
+        rows.add(path, filename, rows.internDir(std::string_view(path).substr(0, path.size() - filename.size())));
+        std::string().swap(path);
+    }
+
     WriteTool* write_tool = new WriteTool;
-    
-    // 输出结果
+    bool write_success = write_tool->write_classified_csv(rows, csv_output_path);
+    delete write_tool;
+    if (write_success) {
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
+
+void AnimGroupMethod::AnimSCVCreateWithNameGroups(const std::string& Infolder, bool recursive,
+                                                  const std::string& csv_output_path, size_t thread_count)
+{
+    AnimsClassifier classifier = MakeClassifier();
+    CompactRowTable rows(classifier);
+    ClassifyToTable(Infolder, recursive, rows);
+
+    AnimNameClusterer clusterer(thread_count);
+    std::vector<uint32_t> group_ids = clusterer.cluster(rows);
+    uint32_t group_count = 0;
+    for (uint32_t id : group_ids) {
+        group_count = std::max(group_count, id);
+    }
+    std::cout << "找到 " << rows.size() << " 个 .Animal 文件，聚类为 " << group_count << " 个动画组" << std::endl;
+
+    WriteTool* write_tool = new WriteTool;
+    bool write_success = write_tool->write_classified_csv(rows, group_ids, csv_output_path);
+    delete write_tool;
+    if (write_success) {
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
+
+void AnimGroupMethod::AnimClassifyStatistics(const std::string& Infolder, bool recursive,
+                                             const std::vector<std::vector<StatColumn>>& group_by,
+                                             AnimStatsFormat format)
+{
+    AnimsClassifier classifier = MakeClassifier();
+    CompactRowTable rows(classifier);
+    ClassifyToTable(Infolder, recursive, rows);
+
+    AnimStatsEngine engine;
+    for (const std::vector<StatColumn>& columns : group_by) {
+        AnimStatsEngine::write(std::cout, engine.groupBy(rows, columns), format);
+    }
+}
+
+void AnimGroupMethod::AnimCategoryTreeReport(const std::string& Infolder, bool recursive,
+                                             const std::vector<std::string>& queries, size_t max_depth,
+                                             AnimStatsFormat format)
+{
+    AnimsClassifier classifier = MakeClassifier();
+    CompactRowTable rows(classifier);
+    ClassifyToTable(Infolder, recursive, rows);
+
+    AnimCategoryTree tree;
+    tree.build(rows);
+    if (queries.empty()) {
+        tree.write(std::cout, format, AnimCategoryTree::kRoot, max_depth);
+        return;
+    }
+    for (const std::string& query : queries) {
+        const uint32_t id = tree.find(query);
+        if (id == AnimCategoryTree::kNoNode) {
+            std::cerr << "错误：目录不存在 -> " << query << std::endl;
+            continue;
+        }
+        if (format == AnimStatsFormat::Console) tree.printNode(std::cout, id);
+        tree.write(std::cout, format, id, max_depth);
+    }
+}
+
+void AnimGroupMethod::AnimReclassifyDiff(const std::string& csv_path, const std::string& diff_csv_path,
+                                         size_t thread_count)
+{
+    CsvReader reader;
+    if (!reader.open(csv_path)) {
+        return;
+    }
+
+    // 表头的前 14 列必须与分类 CSV 相同（之后可以有 group_id 等附加列）
+    const std::vector<std::string> titles = parseCSVLine(kClassifiedCSVHeader);
+    CsvReader::Cursor cursor = reader.rows();
+    CsvRow header;
+    bool header_ok = cursor.next(header) && header.size() >= kClassifiedColumnCount;
+    for (size_t column = 0; header_ok && column < kClassifiedColumnCount; ++column) {
+        header_ok = header[column] == titles[column];
+    }
+    if (!header_ok) {
+        std::cerr << "错误：不是带分类列的 CSV -> " << csv_path << std::endl;
+        return;
+    }
+
+    // 分类过程不修改分类器，各块共用一个
+    AnimsClassifier classifier = MakeClassifier();
+    WorkStealingPool pool(thread_count);
+    const std::vector<CsvReader::Chunk> chunks = reader.split(cursor.offset(), pool.thread_count() * 4, pool);
+    std::vector<ReclassifyChunk> results(chunks.size());
+    for (size_t k = 0; k < chunks.size(); ++k) {
+        pool.submit([&reader, &chunks, &classifier, &titles, &results, k] {
+            reclassify_chunk(reader, chunks[k], classifier, titles, results[k]);
+        });
+    }
+    pool.wait();
+
+    size_t rows = 0;
+    size_t skipped = 0;
+    size_t column_changes[kClassifiedColumnCount] = {};
+    std::vector<CSVRow> changed;
+    std::vector<std::string> changes;
+    for (ReclassifyChunk& result : results) {
+        rows += result.rows;
+        skipped += result.skipped;
+        for (size_t column = kFirstClassColumn; column < kClassifiedColumnCount; ++column) {
+            column_changes[column] += result.column_changes[column];
+        }
+        std::move(result.changed.begin(), result.changed.end(), std::back_inserter(changed));
+        std::move(result.changes.begin(), result.changes.end(), std::back_inserter(changes));
+    }
+
+    std::cout << "读取 " << rows << " 行，重新分类后有变化的 " << changed.size() << " 行";
+    if (skipped > 0) {
+        std::cout << "（列数不足跳过 " << skipped << " 行）";
+    }
+    std::cout << std::endl;
+    for (size_t column = kFirstClassColumn; column < kClassifiedColumnCount; ++column) {
+        if (column_changes[column] > 0) {
+            std::cout << "  " << titles[column] << "：" << column_changes[column] << " 行" << std::endl;
+        }
+    }
+
+    const std::string output_path = diff_csv_path.empty() ? reclassify_path_for_csv(csv_path) : diff_csv_path;
+    WriteTool* write_tool = new WriteTool;
+    bool write_success = write_tool->write_reclassify_diff(changed, changes, output_path);
+    delete write_tool;
+    if (write_success) {
+        std::cout << "提示：用 Excel 直接打开 " << output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
+
+void AnimGroupMethod::AnimSCVCreateWithContentHash(const std::string& Infolder, bool recursive,
+                                                   const std::string& csv_output_path, size_t thread_count,
+                                                   bool hash_all)
+{
+    FindAnim* find_anim = new FindAnim;
+    find_anim->set_filter(m_filter);
+    std::vector<std::string> files = find_anim->find_animal_files(Infolder, recursive);
+    delete find_anim;
+
+    if (files.empty()) {
+        std::cout << "未找到 .Animal 后缀的文件" << std::endl;
+    }
+
+    ContentHasher hasher(thread_count);
+    hasher.set_hash_unique_sizes(hash_all);
+    if (!hasher.hash_files(files)) {
+        std::cerr << "警告：部分文件无法读取，未计算内容哈希" << std::endl;
+    }
+
+    const std::vector<std::vector<size_t>>& groups = hasher.duplicate_groups();
+    size_t duplicate_files = 0;
+    for (const std::vector<size_t>& group : groups) {
+        duplicate_files += group.size();
+    }
+    std::cout << "找到 " << files.size() << " 个 .Animal 文件，计算哈希 " << hasher.hashed_count() << " 个（"
+              << hasher.hashed_bytes() / (1024 * 1024) << " MB）" << std::endl;
+    std::cout << "重复分组 " << groups.size() << " 组，共 " << duplicate_files << " 个文件，可节省 "
+              << hasher.duplicate_bytes() / (1024 * 1024) << " MB" << std::endl;
+
+    WriteTool* write_tool = new WriteTool;
+    bool write_success = write_tool->write_to_csv(files, hasher, csv_output_path);
+    if (write_success && !groups.empty()) {
+        write_success = write_tool->write_duplicate_groups(
+            files, hasher, ContentHasher::duplicates_path_for_csv(csv_output_path));
+    }
+    delete write_tool;
+    if (write_success) {
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
+
+void AnimGroupMethod::AnimSCVCreateWithMetadata(const std::string& Infolder, bool recursive,
+                                                const std::string& csv_output_path, size_t thread_count)
+{
+    FindAnim* find_anim = new FindAnim;
+    find_anim->set_filter(m_filter);
+    std::vector<std::string> files = find_anim->find_animal_files(Infolder, recursive);
+    delete find_anim;
+
     if (files.empty()) {
         std::cout << "未找到 .Animal 后缀的文件" << std::endl;
+    }
+
+    AnimMetadataReader reader;
+    std::vector<AnimFileMetadata> metadata = reader.read_all(files, thread_count);
+    size_t parsed = 0;
+    size_t animations = 0;
+    for (const AnimFileMetadata& meta : metadata) {
+        if (!meta.valid) continue;
+        ++parsed;
+        animations += meta.animation_count;
+    }
+    std::cout << "找到 " << files.size() << " 个 .Animal 文件，解析文件头 " << parsed << " 个，共 "
+              << animations << " 个动画" << std::endl;
+
+    WriteTool* write_tool = new WriteTool;
+    bool write_success = write_tool->write_metadata_csv(files, metadata, csv_output_path);
+    delete write_tool;
+    if (write_success) {
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
     } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
+
+void AnimGroupMethod::AnimSCVCreateBatch(const std::string& root_folder, const std::string& root_csv_output_path,
+                                         const std::vector<AnimCSVOutput>& outputs, size_t thread_count,
+                                         bool incremental)
+{
+    BeginScanStats();
+    FindAnim* find_anim = new FindAnim;
+    find_anim->set_filter(m_filter);
+    find_anim->set_stats(m_stats);
+    // 两种遍历的结果顺序都与串行递归遍历一致，分发后每个分类内部的顺序也与单独遍历该目录一致
+    std::vector<std::string> files;
+    {
+        ScanStageTimer timer(m_stats, "walk");
+        files = incremental
+            ? find_files_incremental(*find_anim, root_folder, root_csv_output_path)
+            : find_anim->find_animal_files_parallel(root_folder, thread_count, true);
+    }
+    delete find_anim;
+
+    WriteResult(files, root_csv_output_path);
+
+    std::vector<std::vector<std::string>> routed;
+    {
+        ScanStageTimer timer(m_stats, "route");
+        routed = RouteByFolder(files, outputs);
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        // 文件列表已随根目录打印过，分类只打印数量
+        std::cout << "分类 " << outputs[i].folder << "：" << routed[i].size() << " 个 .Animal 文件" << std::endl;
+        WriteResult(routed[i], outputs[i].csv_output_path, false);
+    }
+    EndScanStats();
+}
+
+std::vector<std::vector<std::string>> AnimGroupMethod::RouteByFolder(const std::vector<std::string>& files,
+                                                                     const std::vector<AnimCSVOutput>& outputs)
+{
+    std::vector<std::string> folders;
+    folders.reserve(outputs.size());
+    for (const AnimCSVOutput& output : outputs) {
+        folders.push_back(trim_trailing_separator(output.folder));
+    }
+
+    std::vector<std::vector<std::string>> routed(outputs.size());
+    for (const std::string& file : files) {
+        for (size_t i = 0; i < folders.size(); ++i) {
+            if (is_under_folder(file, folders[i])) {
+                routed[i].push_back(file);
+            }
+        }
+    }
+    return routed;
+}
+
+void AnimGroupMethod::ClassifyToTable(const std::string& Infolder, bool recursive, CompactRowTable& rows)
+{
+    FindAnim* find_anim = new FindAnim;
+    find_anim->set_filter(m_filter);
+    PathTable table;
+    find_anim->find_animal_files_table(Infolder, recursive, table);
+    delete find_anim;
+
+    // 路径表的目录ID直接作为分类缓存的目录ID
+    rows.reserve(table.file_count(), 0);
+    std::string full_path;
+    for (uint32_t i = 0; i < table.file_count(); ++i) {
+        full_path.clear();
+        table.append_full_path(i, full_path);
+        rows.add(full_path, table.file_name(i), table.file_dir(i));
+    }
+}
+
+void AnimGroupMethod::WriteResult(const std::vector<std::string>& files, const std::string& csv_output_path,
+                                  bool print_files)
+{
+    WriteTool* write_tool = new WriteTool;
+
+    // 输出结果
+    if (files.empty()) {
+        std::cout << "未找到 .Animal 后缀的文件" << std::endl;
+    } else if (print_files) {
         std::cout << "找到 " << files.size() << " 个 .Animal 文件：" << std::endl;
         for (const auto& file : files) {
             std::cout << " - " << file << std::endl;
-            
+
         }
     }
-    bool write_success = write_tool->write_to_csv(files, csv_output_path);
+    bool write_success;
+    {
+        ScanStageTimer timer(m_stats, "write");
+        write_success = write_tool->write_to_csv(files, csv_output_path);
+    }
+    delete write_tool;
     if (write_success) {
+        record_bytes_written(m_stats, csv_output_path);
         std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
     } else {
         std::cerr << "警告：CSV 文件写入失败！" << std::endl;
     }
 }
 
+void AnimGroupMethod::WriteResult(const PathTable& table, const std::string& csv_output_path)
+{
+    WriteTool* write_tool = new WriteTool;
+
+    // 输出结果
+    if (table.file_count() == 0) {
+        std::cout << "未找到 .Animal 后缀的文件" << std::endl;
+    } else {
+        std::cout << "找到 " << table.file_count() << " 个 .Animal 文件：" << std::endl;
+        std::string full_path;
+        for (uint32_t i = 0; i < table.file_count(); ++i) {
+            full_path.clear();
+            table.append_full_path(i, full_path);
+            std::cout << " - " << full_path << std::endl;
+        }
+    }
+    bool write_success;
+    {
+        ScanStageTimer timer(m_stats, "write");
+        write_success = write_tool->write_to_csv(table, csv_output_path);
+    }
+    delete write_tool;
+    if (write_success) {
+        record_bytes_written(m_stats, csv_output_path);
+        std::cout << "提示：用 Excel 直接打开 " << csv_output_path << " 即可查看表格" << std::endl;
+    } else {
+        std::cerr << "警告：CSV 文件写入失败！" << std::endl;
+    }
+}
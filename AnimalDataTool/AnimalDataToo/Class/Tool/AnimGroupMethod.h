@@ -1,10 +1,108 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
+
+class AnimsClassifier;
+class CompactRowTable;
+class PathTable;
+class ScanFilter;
+class ScanStats;
+enum class ScanStatsFormat;
+enum class StatColumn : uint8_t;
+enum class AnimStatsFormat;
+
+// 批量输出的一个分类：folder 下的文件写入 csv_output_path
+struct AnimCSVOutput
+{
+    std::string folder;
+    std::string csv_output_path;
+};
 
 class AnimGroupMethod
 {
 public:
     AnimGroupMethod();
+    ~AnimGroupMethod();
+
+    AnimGroupMethod(const AnimGroupMethod&) = delete;
+    AnimGroupMethod& operator=(const AnimGroupMethod&) = delete;
+
+    // 开启扫描统计（目录数、目录项、匹配数、系统调用、写出字节、目录列举耗时直方图、各阶段耗时）：
+    // AnimSCVCreate / AnimSCVCreateBatch / AnimSCVCreatePipelined 结束时按 format 输出到标准输出，interval_seconds > 0 时扫描期间定期输出
+    void EnableScanStats(ScanStatsFormat format, unsigned interval_seconds = 0);
+
+    // 查找时使用的过滤器（须已编译，由调用方保证生命周期）；传 nullptr 恢复默认的 .anims 后缀判断
+    void SetScanFilter(const ScanFilter* filter);
+
+    // 分类时使用的规则（调用方先用 AnimsClassifier::loadRules 加载，并保证生命周期）；传 nullptr 恢复内置规则
+    void SetClassifier(const AnimsClassifier* classifier);
 
     void AnimSCVCreate(std::string Infolder, bool recursive,std::string csv_output_path );
+
+    // 流水线模式：扫描、分类、写出三个阶段并行，输出带分类列的 CSV 并打印各阶段吞吐统计
+    void AnimSCVCreatePipelined(const std::string& Infolder, bool recursive, const std::string& csv_output_path);
+
+    // 不解包直接索引 archive_folder 下的 .archive 文件，用哈希列表还原 .anims 路径，输出带分类列的 CSV；
+    // 设置了过滤器时按还原后的路径过滤
+    void AnimSCVCreateFromArchives(const std::string& archive_folder, const std::string& hash_list_path,
+                                   const std::string& csv_output_path);
+
+    // 查找并分类后按文件名聚类近似重复的动画（编号、镜像、体型拷贝等变体），CSV 在分类列之后增加 group_id 列
+    void AnimSCVCreateWithNameGroups(const std::string& Infolder, bool recursive,
+                                     const std::string& csv_output_path, size_t thread_count = 0);
+
+    // 查找并分类后按 group_by 中的每组列做分组统计（例如 武器类型 × 动作类型），按 format 输出到标准输出，不写 CSV
+    void AnimClassifyStatistics(const std::string& Infolder, bool recursive,
+                                const std::vector<std::vector<StatColumn>>& group_by, AnimStatsFormat format);
+
+    // 查找并分类后建立目录前缀树（见 AnimCategoryTree）：queries 为空时按 format 输出 max_depth 层以内的整棵树，
+    // 否则输出每个查询目录（如 "quest/main_quests"）的汇总和它的子树
+    void AnimCategoryTreeReport(const std::string& Infolder, bool recursive, const std::vector<std::string>& queries,
+                                size_t max_depth, AnimStatsFormat format);
+
+    // 读取之前生成的带分类列的 CSV，用当前规则重新分类每一行并与文件中的分类比较：输出各列的变化行数，
+    // 有变化的行写入 diff_csv_path（为空时为 xxx_reclassified.csv）。大文件分块在线程池上解析和分类
+    void AnimReclassifyDiff(const std::string& csv_path, const std::string& diff_csv_path = std::string(),
+                            size_t thread_count = 0);
+
+    // 查找后计算内容哈希：CSV 增加 content_hash 列，重复分组写入 xxx_duplicates.csv
+    // hash_all 为 false 时大小唯一的文件不计算哈希（不可能重复）
+    void AnimSCVCreateWithContentHash(const std::string& Infolder, bool recursive,
+                                      const std::string& csv_output_path, size_t thread_count = 0,
+                                      bool hash_all = false);
+
+    // 查找后在线程池上解析每个 .anims 的文件头，CSV 增加动画数量、骨骼、动画名称和时长列
+    void AnimSCVCreateWithMetadata(const std::string& Infolder, bool recursive,
+                                   const std::string& csv_output_path, size_t thread_count = 0);
+
+    // 只遍历一次根目录，按路径前缀把结果分发到根目录 CSV 和各分类 CSV
+    // incremental 为 true 时使用根目录 CSV 旁边的扫描清单做增量遍历（串行），
+    // 否则在 thread_count 个线程上并行遍历（0 为全部硬件线程）
+    void AnimSCVCreateBatch(const std::string& root_folder, const std::string& root_csv_output_path,
+                            const std::vector<AnimCSVOutput>& outputs, size_t thread_count = 0,
+                            bool incremental = false);
+
+    // 按路径前缀把文件分发到各分类（目录可以嵌套，一个文件可能属于多个分类），保持输入顺序
+    static std::vector<std::vector<std::string>> RouteByFolder(const std::vector<std::string>& files,
+                                                              const std::vector<AnimCSVOutput>& outputs);
+
+private:
+    // 各次分类使用的分类器：复制 SetClassifier 设置的分类器（共享已加载的规则），未设置时为内置规则
+    AnimsClassifier MakeClassifier() const;
+    // 查找 Infolder 下的文件并逐行分类到 rows（rows 绑定的分类器由调用方持有）
+    void ClassifyToTable(const std::string& Infolder, bool recursive, CompactRowTable& rows);
+    void WriteResult(const std::vector<std::string>& files, const std::string& csv_output_path,
+                     bool print_files = true);
+    void WriteResult(const PathTable& table, const std::string& csv_output_path);
+
+    void BeginScanStats();
+    void EndScanStats();
+
+    bool m_statsEnabled = false;
+    ScanStatsFormat m_statsFormat;
+    unsigned m_statsInterval = 0;
+    ScanStats* m_stats = nullptr;  // 只在一次扫描期间存在
+    const ScanFilter* m_filter = nullptr;
+    const AnimsClassifier* m_classifier = nullptr;
 };
@@ -0,0 +1,222 @@
+﻿#include "AnimMetadata.h"
+
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include "MappedFile.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    // CR2W 文件格式（小端）：
+    //   文件头 40 字节：magic, version, flags, timeStamp(u64), buildVersion, objectsEnd, buffersEnd, crc32, numChunks
+    //   之后是 10 个表头，每个 12 字节：offset, itemCount, crc32
+    //     0 字符串池（itemCount 为字节数） 1 名字表 {offset, hash}            8 字节
+    //     2 导入表 {offset, className(u16), flags(u16)}                      8 字节
+    //     4 导出表 {className(u16), objectFlags(u16), parentID, dataSize, dataOffset, template, crc32} 24 字节
+    //   导出对象数据：1 字节 0，u16 字段数，之后每个字段 {name(u16), type(u16), offset(u32)}，
+    //   offset 相对于对象数据起点；name/type 为名字表下标
+    const uint32_t kCR2WMagic = 0x57325243;  // "CR2W"
+    const size_t kFileHeaderSize = 40;
+    const size_t kTableHeaderSize = 12;
+    const size_t kTableCount = 10;
+    const size_t kNameEntrySize = 8;
+    const size_t kImportEntrySize = 8;
+    const size_t kExportEntrySize = 24;
+    const size_t kFieldDescSize = 8;
+
+    enum TableId
+    {
+        kStringTable = 0,
+        kNameTable = 1,
+        kImportTable = 2,
+        kExportTable = 4,
+    };
+
+    template <typename T>
+    T read_le(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    bool ends_with_rig(std::string_view path)
+    {
+        static const char suffix[] = ".rig";
+        const size_t suffix_len = sizeof(suffix) - 1;
+        if (path.size() < suffix_len) return false;
+        for (size_t i = 0; i < suffix_len; ++i) {
+            char c = path[path.size() - suffix_len + i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != suffix[i]) return false;
+        }
+        return true;
+    }
+
+    // 带边界检查的 CR2W 表访问
+    class CR2WView
+    {
+    public:
+        CR2WView(const uint8_t* data, size_t size) : m_data(data), m_size(size)
+        {
+        }
+
+        bool init()
+        {
+            if (m_size < kFileHeaderSize + kTableCount * kTableHeaderSize) return false;
+            if (read_le<uint32_t>(m_data) != kCR2WMagic) return false;
+            for (size_t i = 0; i < kTableCount; ++i) {
+                const uint8_t* header = m_data + kFileHeaderSize + i * kTableHeaderSize;
+                m_tableOffset[i] = read_le<uint32_t>(header);
+                m_tableCount[i] = read_le<uint32_t>(header + 4);
+            }
+            return table_fits(kStringTable, 1) && table_fits(kNameTable, kNameEntrySize) &&
+                   table_fits(kImportTable, kImportEntrySize) && table_fits(kExportTable, kExportEntrySize);
+        }
+
+        uint32_t version() const { return read_le<uint32_t>(m_data + 4); }
+        uint32_t count(TableId table) const { return m_tableCount[table]; }
+
+        const uint8_t* entry(TableId table, uint32_t index, size_t entry_size) const
+        {
+            return m_data + m_tableOffset[table] + static_cast<size_t>(index) * entry_size;
+        }
+
+        // 字符串池中以 0 结尾的字符串；越界返回空串
+        std::string_view string_at(uint32_t offset) const
+        {
+            const size_t pool_size = m_tableCount[kStringTable];
+            if (offset >= pool_size) return std::string_view();
+            const char* begin = reinterpret_cast<const char*>(m_data + m_tableOffset[kStringTable] + offset);
+            const void* nul = std::memchr(begin, 0, pool_size - offset);
+            const size_t length = nul ? static_cast<const char*>(nul) - begin : pool_size - offset;
+            return std::string_view(begin, length);
+        }
+
+        std::string_view name(uint32_t index) const
+        {
+            if (index >= m_tableCount[kNameTable]) return std::string_view();
+            return string_at(read_le<uint32_t>(entry(kNameTable, index, kNameEntrySize)));
+        }
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        bool table_fits(TableId table, size_t entry_size) const
+        {
+            const uint64_t end = static_cast<uint64_t>(m_tableOffset[table]) +
+                                 static_cast<uint64_t>(m_tableCount[table]) * entry_size;
+            return end <= m_size;
+        }
+
+        const uint8_t* m_data;
+        size_t m_size;
+        uint32_t m_tableOffset[kTableCount] = {};
+        uint32_t m_tableCount[kTableCount] = {};
+    };
+
+    // 解析 animAnimation 对象的字段表，只读取 name 和 duration 两个字段
+    AnimClipInfo parse_animation(const CR2WView& view, uint32_t data_offset, uint32_t data_size)
+    {
+        AnimClipInfo clip;
+        const uint64_t object_end = static_cast<uint64_t>(data_offset) + data_size;
+        if (data_size < 3 || object_end > view.size()) return clip;
+
+        const uint8_t* object = view.data() + data_offset;
+        if (object[0] != 0) return clip;
+        const uint16_t field_count = read_le<uint16_t>(object + 1);
+        if (3 + static_cast<uint64_t>(field_count) * kFieldDescSize > data_size) return clip;
+
+        for (uint16_t i = 0; i < field_count; ++i) {
+            const uint8_t* desc = object + 3 + static_cast<size_t>(i) * kFieldDescSize;
+            const std::string_view field = view.name(read_le<uint16_t>(desc));
+            const std::string_view type = view.name(read_le<uint16_t>(desc + 2));
+            const uint32_t offset = read_le<uint32_t>(desc + 4);
+
+            if (field == "name" && type == "CName" && static_cast<uint64_t>(offset) + 2 <= data_size) {
+                clip.name = std::string(view.name(read_le<uint16_t>(object + offset)));
+            } else if (field == "duration" && type == "Float" && static_cast<uint64_t>(offset) + 4 <= data_size) {
+                clip.duration = read_le<float>(object + offset);
+            }
+        }
+        return clip;
+    }
+}
+
+AnimMetadataReader::AnimMetadataReader()
+{
+}
+
+bool AnimMetadataReader::parse(const uint8_t* data, size_t size, AnimFileMetadata& metadata)
+{
+    metadata = AnimFileMetadata();
+    CR2WView view(data, size);
+    if (!view.init()) return false;
+    metadata.version = view.version();
+
+    // 骨骼：导入表中第一个 .rig 资源
+    for (uint32_t i = 0; i < view.count(kImportTable); ++i) {
+        const uint8_t* import = view.entry(kImportTable, i, kImportEntrySize);
+        const std::string_view class_name = view.name(read_le<uint16_t>(import + 4));
+        const std::string_view path = view.string_at(read_le<uint32_t>(import));
+        if (class_name == "animRig" || ends_with_rig(path)) {
+            metadata.rig_path = std::string(path);
+            break;
+        }
+    }
+
+    // 动画：每个 animAnimation 导出对象对应一个动画
+    for (uint32_t i = 0; i < view.count(kExportTable); ++i) {
+        const uint8_t* object = view.entry(kExportTable, i, kExportEntrySize);
+        if (view.name(read_le<uint16_t>(object)) != "animAnimation") continue;
+        const uint32_t data_size = read_le<uint32_t>(object + 8);
+        const uint32_t data_offset = read_le<uint32_t>(object + 12);
+        metadata.animations.push_back(parse_animation(view, data_offset, data_size));
+    }
+    metadata.animation_count = static_cast<uint32_t>(metadata.animations.size());
+    metadata.valid = true;
+    return true;
+}
+
+bool AnimMetadataReader::read(const std::string& path, AnimFileMetadata& metadata)
+{
+    metadata = AnimFileMetadata();
+    MappedFile file;
+    if (!file.open(path)) return false;
+    file.advise_random();
+    if (!parse(file.data(), file.size(), metadata)) {
+        std::cerr << "错误：不是有效的 CR2W 文件 -> " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<AnimFileMetadata> AnimMetadataReader::read_all(const std::vector<std::string>& files,
+                                                           size_t thread_count)
+{
+    std::vector<AnimFileMetadata> results(files.size());
+    std::vector<uint8_t> invalid(files.size(), 0);
+
+    // 每个文件一个任务；结果写入各自的下标，无需加锁
+    WorkStealingPool pool(thread_count);
+    for (size_t i = 0; i < files.size(); ++i) {
+        pool.submit([&files, &results, &invalid, i] {
+            MappedFile file;
+            if (!file.open(files[i])) return;
+            file.advise_random();
+            if (!parse(file.data(), file.size(), results[i])) invalid[i] = 1;
+        });
+    }
+    pool.wait();
+
+    // 解析失败的文件在主线程统一报告，避免多线程输出交错
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (invalid[i]) {
+            std::cerr << "错误：不是有效的 CR2W 文件 -> " << files[i] << std::endl;
+        }
+    }
+    return results;
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 单个动画（animAnimation 导出对象）的信息
+struct AnimClipInfo
+{
+    std::string name;
+    float duration = 0.0f;  // 秒；未序列化该字段时为 0
+};
+
+// 从 .anims（CR2W 资源）文件头解析出的元数据
+struct AnimFileMetadata
+{
+    bool valid = false;
+    uint32_t version = 0;
+    uint32_t animation_count = 0;
+    std::string rig_path;  // 导入表中引用的 .rig 路径
+    std::vector<AnimClipInfo> animations;
+};
+
+// .anims 元数据读取：内存映射后只解析文件头、名字表、导入表、导出表和 animAnimation 对象的字段表，
+// 动画数据本身所在的缓冲区不会被访问，因此每个文件只触及开头的少数页面
+class AnimMetadataReader
+{
+public:
+    AnimMetadataReader();
+
+    // 读取单个文件；不是有效的 CR2W 文件时返回 false
+    bool read(const std::string& path, AnimFileMetadata& metadata);
+
+    // 在工作窃取线程池上读取所有文件，结果与 files 一一对应；thread_count 为 0 时使用硬件线程数
+    std::vector<AnimFileMetadata> read_all(const std::vector<std::string>& files, size_t thread_count = 0);
+
+    // 解析已加载到内存中的 CR2W 数据
+    static bool parse(const uint8_t* data, size_t size, AnimFileMetadata& metadata);
+};
@@ -0,0 +1,289 @@
+﻿#include "AnimNameCluster.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "AnimGroup.h"
+#include "CompactRow.h"
+#include "StringKernels.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    const size_t kClusterChunk = 4096;
+
+    // 变体标记、左右镜像和体型词：只区分同一动作的不同拷贝，不参与分组
+    const std::string_view kIgnoredTokens[] = {
+        "var", "variant", "alt",
+        "l", "r", "left", "right", "lh", "rh", "mirror", "mirrored",
+        "ma", "wa", "pma", "pwa", "man", "woman", "male", "female",
+        "average", "big", "fat", "massive", "chubby", "child", "boy", "girl",
+    };
+
+    bool is_ignored(std::string_view token)
+    {
+        if (std::all_of(token.begin(), token.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return true;
+        }
+        for (std::string_view ignored : kIgnoredTokens) {
+            if (token == ignored) return true;
+        }
+        return false;
+    }
+
+    inline bool is_digit(unsigned char c) { return c >= '0' && c <= '9'; }
+
+    // 字母、数字和非 ASCII 字节（中文等）属于词的一部分
+    inline bool is_word(unsigned char c)
+    {
+        return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+    }
+
+    inline uint64_t mix64(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    inline uint64_t hash_bytes(const char* data, size_t size)
+    {
+        uint64_t h = 0xCBF29CE484222325ull;
+        for (size_t i = 0; i < size; ++i) {
+            h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001B3ull;
+        }
+        return h;
+    }
+
+    struct Signature
+    {
+        uint32_t values[AnimNameClusterer::kSignatureSize];
+    };
+
+    // 特征集合：每个词，以及相邻两个词组成的有序词对
+    void compute_signature(const std::string& normalized, Signature& signature)
+    {
+        static const struct Seeds
+        {
+            uint64_t values[AnimNameClusterer::kSignatureSize];
+            Seeds()
+            {
+                for (size_t i = 0; i < AnimNameClusterer::kSignatureSize; ++i) {
+                    values[i] = mix64(0x9E3779B97F4A7C15ull * (i + 1));
+                }
+            }
+        } seeds;
+
+        std::fill(std::begin(signature.values), std::end(signature.values), 0xFFFFFFFFu);
+        const auto add_feature = [&signature](uint64_t feature) {
+            for (size_t i = 0; i < AnimNameClusterer::kSignatureSize; ++i) {
+                const uint32_t value = static_cast<uint32_t>(mix64(feature ^ seeds.values[i]));
+                if (value < signature.values[i]) signature.values[i] = value;
+            }
+        };
+
+        uint64_t previous = 0;
+        bool has_previous = false;
+        size_t begin = 0;
+        while (begin <= normalized.size()) {
+            size_t end = normalized.find('_', begin);
+            if (end == std::string::npos) end = normalized.size();
+            if (end > begin) {
+                const uint64_t token = hash_bytes(normalized.data() + begin, end - begin);
+                add_feature(token);
+                if (has_previous) add_feature(mix64(previous * 31 + token));
+                previous = token;
+                has_previous = true;
+            }
+            begin = end + 1;
+        }
+    }
+
+    double similarity(const Signature& a, const Signature& b)
+    {
+        size_t same = 0;
+        for (size_t i = 0; i < AnimNameClusterer::kSignatureSize; ++i) {
+            if (a.values[i] == b.values[i]) ++same;
+        }
+        return static_cast<double>(same) / AnimNameClusterer::kSignatureSize;
+    }
+
+    // 按块在线程池上执行 fn(begin, end)；不足两块或只有一个线程时直接执行
+    template <typename Fn>
+    void for_each_chunk(size_t count, size_t thread_count, Fn fn)
+    {
+        if (thread_count == 0) {
+            thread_count = std::thread::hardware_concurrency();
+        }
+        if (thread_count <= 1 || count < 2 * kClusterChunk) {
+            fn(size_t(0), count);
+            return;
+        }
+        WorkStealingPool pool(thread_count);
+        for (size_t begin = 0; begin < count; begin += kClusterChunk) {
+            const size_t end = std::min(count, begin + kClusterChunk);
+            pool.submit([&fn, begin, end] { fn(begin, end); });
+        }
+        pool.wait();
+    }
+
+    // LSH 分带的桶表：键为 带序号 + 该带签名值 的哈希，值为最先落入该桶的名称；
+    // 开放寻址（线性探测），所有带共用一张表，容量固定为条目上限的两倍以上
+    class BandTable
+    {
+    public:
+        explicit BandTable(size_t max_entries)
+        {
+            size_t capacity = 64;
+            while (capacity < max_entries * 2) capacity *= 2;
+            m_keys.assign(capacity, 0);
+            m_values.assign(capacity, kEmpty);
+        }
+
+        // 返回桶中已有的名称；桶为空时放入 value 并返回 kEmpty
+        uint32_t findOrInsert(uint64_t key, uint32_t value)
+        {
+            const size_t mask = m_keys.size() - 1;
+            for (size_t slot = static_cast<size_t>(key) & mask;; slot = (slot + 1) & mask) {
+                if (m_values[slot] == kEmpty) {
+                    m_keys[slot] = key;
+                    m_values[slot] = value;
+                    return kEmpty;
+                }
+                if (m_keys[slot] == key) return m_values[slot];
+            }
+        }
+
+        static constexpr uint32_t kEmpty = 0xFFFFFFFFu;
+
+    private:
+        std::vector<uint64_t> m_keys;
+        std::vector<uint32_t> m_values;
+    };
+}
+
+AnimNameClusterer::AnimNameClusterer(size_t thread_count)
+    : m_threadCount(thread_count)
+{
+}
+
+void AnimNameClusterer::setMinSimilarity(double similarity)
+{
+    m_minSimilarity = similarity;
+}
+
+std::string AnimNameClusterer::normalizeName(std::string_view filename)
+{
+    const size_t dot = filename.find_last_of('.');
+    const std::string_view stem = dot != std::string_view::npos && dot > 0 ? filename.substr(0, dot) : filename;
+
+    // 小写字符直接追加到结果中，词结束时若应丢弃再截掉（连同前面的 '_'）
+    std::string normalized;
+    normalized.reserve(stem.size());
+    size_t token_begin = 0;
+    const auto flush = [&normalized, &token_begin] {
+        if (normalized.size() == token_begin) return;
+        if (is_ignored(std::string_view(normalized).substr(token_begin))) {
+            normalized.resize(token_begin > 0 ? token_begin - 1 : 0);
+        }
+    };
+    bool in_token = false;
+    for (size_t i = 0; i < stem.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(stem[i]);
+        // 字母与数字的交界也是词的边界（idle02 -> idle, 02）
+        if (in_token && (!is_word(c) || is_digit(c) != is_digit(static_cast<unsigned char>(normalized.back())))) {
+            flush();
+            in_token = false;
+        }
+        if (!is_word(c)) continue;
+        if (!in_token) {
+            if (!normalized.empty()) normalized.push_back('_');
+            token_begin = normalized.size();
+            in_token = true;
+        }
+        normalized.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : static_cast<char>(c));
+    }
+    if (in_token) flush();
+
+    if (normalized.empty()) {
+        StringKernels::lowerInto(stem, normalized);
+    }
+    return normalized;
+}
+
+std::vector<uint32_t> AnimNameClusterer::cluster(const std::vector<std::string_view>& names) const
+{
+    // 1. 规范化（并行），规范化结果相同的名称共用一个签名
+    std::vector<std::string> normalized(names.size());
+    for_each_chunk(names.size(), m_threadCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) normalized[i] = normalizeName(names[i]);
+    });
+
+    std::unordered_map<std::string, uint32_t> unique_ids;
+    unique_ids.reserve(names.size());
+    std::vector<uint32_t> unique_of(names.size());
+    std::vector<const std::string*> unique_names;
+    for (size_t i = 0; i < names.size(); ++i) {
+        auto inserted = unique_ids.emplace(std::move(normalized[i]), static_cast<uint32_t>(unique_names.size()));
+        if (inserted.second) unique_names.push_back(&inserted.first->first);
+        unique_of[i] = inserted.first->second;
+    }
+
+    // 2. MinHash 签名（并行）
+    std::vector<Signature> signatures(unique_names.size());
+    for_each_chunk(unique_names.size(), m_threadCount, [&](size_t begin, size_t end) {
+        for (size_t u = begin; u < end; ++u) compute_signature(*unique_names[u], signatures[u]);
+    });
+
+    // 3. LSH 分带：每个组以第一个名称为代表，新名称只与候选桶所属组的代表比较，
+    //    相似度达到阈值就加入该组，否则自成一组。组内名称都与代表相似，不会沿着相似链无限扩大
+    std::vector<uint32_t> group_of(unique_names.size());
+    std::vector<uint32_t> leaders;
+    BandTable buckets(unique_names.size() * kBands);
+    for (uint32_t u = 0; u < unique_names.size(); ++u) {
+        uint32_t group = BandTable::kEmpty;
+        for (size_t band = 0; band < kBands; ++band) {
+            uint64_t key = mix64(band + 1);
+            for (size_t r = 0; r < kBandRows; ++r) {
+                key = mix64(key ^ signatures[u].values[band * kBandRows + r]);
+            }
+            const uint32_t candidate = buckets.findOrInsert(key, u);
+            if (group == BandTable::kEmpty && candidate != BandTable::kEmpty) {
+                const uint32_t candidate_group = group_of[candidate];
+                if (similarity(signatures[u], signatures[leaders[candidate_group]]) >= m_minSimilarity) {
+                    group = candidate_group;
+                }
+            }
+        }
+        if (group == BandTable::kEmpty) {
+            group = static_cast<uint32_t>(leaders.size());
+            leaders.push_back(u);
+        }
+        group_of[u] = group;
+    }
+
+    // 4. 按每组第一次出现的顺序编号（名称按第一次出现的顺序编号，组也是）
+    std::vector<uint32_t> group_ids(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        group_ids[i] = group_of[unique_of[i]] + 1;
+    }
+    return group_ids;
+}
+
+std::vector<uint32_t> AnimNameClusterer::cluster(const CompactRowTable& table) const
+{
+    std::vector<std::string_view> names(table.size());
+    for (size_t i = 0; i < table.size(); ++i) names[i] = table.filename(i);
+    return cluster(names);
+}
+
+std::vector<uint32_t> AnimNameClusterer::cluster(const std::vector<CSVRow>& rows) const
+{
+    std::vector<std::string_view> names(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) names[i] = rows[i].filename;
+    return cluster(names);
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CompactRowTable;
+struct CSVRow;
+
+// 近似重复的动画名称聚类（用于重定向时按"动画组"处理同一动作的各种变体）。
+// 文件名先规范化：去掉扩展名、转小写、按 '_' '-' '.' 空格和字母/数字边界切分，
+// 丢弃编号（01、02）、变体标记（var、alt）、左右镜像（l、r、left、right）和体型词（ma、wa、male、average 等），
+// 规范化结果相同的名称直接归为一组。不同的规范化名称以 词 + 相邻词对 为特征集合计算 MinHash 签名，
+// 再用 LSH 分带：任一带的签名值完全相同的名称成为候选，与候选所在组的第一个名称（代表）
+// 估计的 Jaccard 相似度达到阈值才加入该组。每个名称只查 kBands 次桶表、最多比较 kBands 次签名，
+// 总耗时与行数近似线性，不做两两比较；分组结果只取决于名称的输入顺序，与线程数无关
+class AnimNameClusterer
+{
+public:
+    static constexpr size_t kSignatureSize = 32;
+    static constexpr size_t kBandRows = 4;
+    static constexpr size_t kBands = kSignatureSize / kBandRows;  // 候选阈值约为 (1/kBands)^(1/kBandRows) ≈ 0.59
+
+    // thread_count 为 0 时使用硬件线程数（只用于计算签名）
+    explicit AnimNameClusterer(size_t thread_count = 0);
+
+    // 加入已有组所需的最小估计相似度（与代表的签名中相同位置取值相同的比例），默认 0.6
+    void setMinSimilarity(double similarity);
+
+    // 返回与 names 一一对应的分组编号：从 1 开始，按每组第一次出现的顺序编号
+    std::vector<uint32_t> cluster(const std::vector<std::string_view>& names) const;
+    std::vector<uint32_t> cluster(const CompactRowTable& table) const;
+    std::vector<uint32_t> cluster(const std::vector<CSVRow>& rows) const;
+
+    // 规范化后的名称（保留的词以 '_' 连接）；所有词都被丢弃时返回小写的原名（不含扩展名）
+    static std::string normalizeName(std::string_view filename);
+
+private:
+    size_t m_threadCount;
+    double m_minSimilarity = 0.6;
+};
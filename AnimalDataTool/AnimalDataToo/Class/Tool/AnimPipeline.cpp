@@ -0,0 +1,176 @@
+﻿#include "AnimPipeline.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "AnimGroup.h"
+#include "BoundedQueue.h"
+#include "CsvWriter.h"
+#include "DirClassCache.h"
+#include "FindAnim.h"
+#include "PathTable.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double seconds_since(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // 消费者侧的队列占用采样
+    struct OccupancySampler
+    {
+        size_t samples = 0;
+        size_t sum = 0;
+        size_t max = 0;
+
+        template <typename Queue>
+        void sample(const Queue& queue)
+        {
+            size_t size = queue.size_approx();
+            sum += size;
+            ++samples;
+            if (size > max) max = size;
+        }
+
+        template <typename Queue>
+        PipelineQueueStats finish(const Queue& queue) const
+        {
+            PipelineQueueStats stats;
+            stats.capacity = queue.capacity();
+            stats.max_occupancy = max;
+            stats.avg_occupancy = samples ? static_cast<double>(sum) / samples : 0.0;
+            stats.empty_waits = queue.pop_stalls();
+            return stats;
+        }
+    };
+
+    void print_stage(std::ostream& out, const char* name, const PipelineStageStats& stage)
+    {
+        double rate = stage.seconds > 0.0 ? stage.items / stage.seconds : 0.0;
+        out << "  " << std::left << std::setw(10) << name << std::right
+            << std::setw(10) << stage.items << " 项  "
+            << std::fixed << std::setprecision(3) << std::setw(9) << stage.seconds << " 秒  "
+            << std::setprecision(0) << std::setw(10) << rate << " 项/秒  "
+            << "下游队列满等待 " << stage.stalls << " 次\n";
+    }
+
+    void print_queue(std::ostream& out, const char* name, const PipelineQueueStats& queue)
+    {
+        out << "  " << std::left << std::setw(18) << name << std::right
+            << "容量 " << queue.capacity
+            << "  平均占用 " << std::fixed << std::setprecision(1) << queue.avg_occupancy
+            << "  最大占用 " << queue.max_occupancy
+            << "  读空等待 " << queue.empty_waits << " 次\n";
+    }
+}
+
+AnimPipeline::AnimPipeline(const AnimsClassifier* classifier)
+    : m_classifier(classifier)
+{
+}
+
+bool AnimPipeline::run(const std::string& folder, bool recursive, const std::string& csv_output_path,
+                       size_t queue_capacity)
+{
+    m_stats = PipelineStats();
+
+    CsvWriter csv_file;
+    if (!csv_file.open(csv_output_path)) {
+        std::cerr << "错误：无法创建/打开 CSV 文件 -> " << csv_output_path << std::endl;
+        return false;
+    }
+
+    BoundedQueue<std::string> path_queue(queue_capacity);
+    BoundedQueue<CSVRow> row_queue(queue_capacity);
+    OccupancySampler path_sampler;
+    OccupancySampler row_sampler;
+    bool walk_ok = true;
+    bool write_ok = true;
+
+    const Clock::time_point start = Clock::now();
+
+    // 阶段 1：目录遍历
+    std::thread walker([&] {
+        const Clock::time_point stage_start = Clock::now();
+        FindAnim find_anim;
+        find_anim.set_filter(m_filter);
+        find_anim.set_stats(m_scanStats);
+        walk_ok = find_anim.walk_animal_files(folder, recursive, [&](std::string&& file) {
+            path_queue.push(std::move(file));
+            ++m_stats.walk.items;
+        });
+        path_queue.close();
+        m_stats.walk.seconds = seconds_since(stage_start);
+        m_stats.walk.stalls = path_queue.push_stalls();
+    });
+
+    // 阶段 2：分类
+    std::thread classifier([&] {
+        const Clock::time_point stage_start = Clock::now();
+        AnimsClassifier anims_classifier = m_classifier ? *m_classifier : AnimsClassifier();
+        DirClassCache dir_cache;
+        std::string path;
+        while (path_queue.pop(path)) {
+            path_sampler.sample(path_queue);
+            CSVRow row;
+            row.index = std::to_string(++m_stats.classify.items);
+            row.filename = PathTable::file_name_of(path);
+            row.fullpath = std::move(path);
+            // 同一目录下的文件复用目录部分的分类结果
+            const std::string_view dir_part(row.fullpath.data(),
+                                            row.fullpath.size() - std::min(row.filename.size(), row.fullpath.size()));
+            anims_classifier.classifyRow(row, dir_cache.internDir(dir_part), dir_cache);
+            row_queue.push(std::move(row));
+        }
+        row_queue.close();
+        m_stats.classify.seconds = seconds_since(stage_start);
+        m_stats.classify.stalls = row_queue.push_stalls();
+    });
+
+    // 阶段 3：写出（当前线程）
+    {
+        const Clock::time_point stage_start = Clock::now();
+        csv_file.append(kClassifiedCSVHeader);
+        csv_file.end_row();
+        CSVRow row;
+        while (row_queue.pop(row)) {
+            row_sampler.sample(row_queue);
+            // 写盘由 CsvWriter 的后台线程完成，这里只格式化
+            appendClassifiedFields(csv_file.buffer(), row);
+            csv_file.end_row();
+            ++m_stats.write.items;
+        }
+        write_ok = csv_file.close();
+        m_stats.write.seconds = seconds_since(stage_start);
+    }
+
+    walker.join();
+    classifier.join();
+
+    m_stats.total_seconds = seconds_since(start);
+    m_stats.walk_to_classify = path_sampler.finish(path_queue);
+    m_stats.classify_to_write = row_sampler.finish(row_queue);
+
+    if (!walk_ok || !write_ok) return false;
+    std::cout << "CSV 文件已成功生成：" << csv_output_path << std::endl;
+    return true;
+}
+
+void AnimPipeline::print_stats(std::ostream& out) const
+{
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "\n【流水线统计】总耗时 " << std::fixed << std::setprecision(3) << m_stats.total_seconds << " 秒\n";
+    print_stage(out, "扫描", m_stats.walk);
+    print_stage(out, "分类", m_stats.classify);
+    print_stage(out, "写出", m_stats.write);
+    print_queue(out, "扫描 → 分类 队列", m_stats.walk_to_classify);
+    print_queue(out, "分类 → 写出 队列", m_stats.classify_to_write);
+    out.flags(flags);
+    out.precision(precision);
+}
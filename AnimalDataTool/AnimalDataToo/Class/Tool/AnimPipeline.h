@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+class AnimsClassifier;
+class ScanFilter;
+class ScanStats;
+
+// 单个阶段的吞吐统计
+struct PipelineStageStats
+{
+    size_t items = 0;
+    double seconds = 0.0;  // 阶段线程从启动到结束的时间
+    size_t stalls = 0;     // 因下游队列满而等待的次数
+};
+
+// 阶段之间队列的占用统计（由消费者每次取数据时采样）
+struct PipelineQueueStats
+{
+    size_t capacity = 0;
+    size_t max_occupancy = 0;
+    double avg_occupancy = 0.0;
+    size_t empty_waits = 0;  // 消费者因队列空而等待的次数
+};
+
+struct PipelineStats
+{
+    PipelineStageStats walk;
+    PipelineStageStats classify;
+    PipelineStageStats write;
+    PipelineQueueStats walk_to_classify;
+    PipelineQueueStats classify_to_write;
+    double total_seconds = 0.0;
+};
+
+// 流式 扫描 → 分类 → 写出 流水线：三个阶段各占一个线程，用有界无锁队列连接，
+// 内存占用只与队列容量有关，与仓库大小无关；输出与先收集再分类写出完全一致
+class AnimPipeline
+{
+public:
+    // classifier 为 nullptr 时使用内置规则（由调用方保证生命周期）
+    explicit AnimPipeline(const AnimsClassifier* classifier = nullptr);
+
+    // 扫描阶段的过滤器和扫描统计，含义同 FindAnim::set_filter / set_stats（由调用方保证生命周期）
+    void set_filter(const ScanFilter* filter) { m_filter = filter; }
+    void set_scan_stats(ScanStats* stats) { m_scanStats = stats; }
+
+    bool run(const std::string& folder, bool recursive, const std::string& csv_output_path,
+             size_t queue_capacity = 4096);
+
+    const PipelineStats& stats() const { return m_stats; }
+    void print_stats(std::ostream& out) const;
+
+private:
+    PipelineStats m_stats;
+    const AnimsClassifier* m_classifier;
+    const ScanFilter* m_filter = nullptr;
+    ScanStats* m_scanStats = nullptr;
+};
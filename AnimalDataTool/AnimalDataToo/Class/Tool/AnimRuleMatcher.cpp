@@ -0,0 +1,314 @@
+﻿#include "AnimRuleMatcher.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <queue>
+
+#include "StringKernels.h"
+
+namespace
+{
+    const char* const kGroupNames[kRuleGroupCount] = {"body", "action", "scene", "weapon", "cyberware", "tag"};
+
+    // 体型/动作/场景组的输出按分类名排序（与原 std::map 的遍历顺序一致）
+    bool is_sorted_group(size_t group)
+    {
+        return group <= static_cast<size_t>(RuleGroup::Scene);
+    }
+
+    // 武器/义体组只输出第一个命中的分类
+    bool is_first_match_group(size_t group)
+    {
+        return group == static_cast<size_t>(RuleGroup::Weapon) || group == static_cast<size_t>(RuleGroup::Cyberware);
+    }
+
+    inline char to_lower_ascii(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    std::string trim(const std::string& text)
+    {
+        const size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) return std::string();
+        const size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+}
+
+AnimRuleMatcher::AnimRuleMatcher()
+{
+    compile();
+}
+
+void AnimRuleMatcher::clear()
+{
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        m_categories[g].clear();
+        m_order[g].clear();
+    }
+    compile();
+}
+
+bool AnimRuleMatcher::addPattern(RuleGroup group, const std::string& category, const std::string& keywords)
+{
+    std::vector<Category>& categories = m_categories[static_cast<size_t>(group)];
+    auto it = std::find_if(categories.begin(), categories.end(),
+                           [&](const Category& c) { return c.name == category; });
+    if (it == categories.end()) {
+        if (categories.size() >= 64) {
+            std::cerr << "错误：规则组 " << kGroupNames[static_cast<size_t>(group)]
+                      << " 的分类超过 64 个 -> " << category << std::endl;
+            return false;
+        }
+        categories.push_back(Category());
+        categories.back().name = category;
+        it = categories.end() - 1;
+    }
+
+    size_t begin = 0;
+    while (begin <= keywords.size()) {
+        size_t end = keywords.find('|', begin);
+        if (end == std::string::npos) end = keywords.size();
+        std::string text = trim(keywords.substr(begin, end - begin));
+        Keyword keyword;
+        if (text.compare(0, 2, "\\b") == 0) {
+            keyword.wordStart = true;
+            text.erase(0, 2);
+        }
+        std::transform(text.begin(), text.end(), text.begin(), to_lower_ascii);
+        if (!text.empty()) {
+            keyword.text = std::move(text);
+            it->keywords.push_back(std::move(keyword));
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool AnimRuleMatcher::compile()
+{
+    // 1. 分类位序号：体型/动作/场景按名称排序，其余按添加顺序
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        m_order[g].resize(m_categories[g].size());
+        for (size_t i = 0; i < m_order[g].size(); ++i) m_order[g][i] = static_cast<uint8_t>(i);
+        if (is_sorted_group(g)) {
+            const std::vector<Category>& categories = m_categories[g];
+            std::sort(m_order[g].begin(), m_order[g].end(),
+                      [&](uint8_t a, uint8_t b) { return categories[a].name < categories[b].name; });
+        }
+    }
+
+    // 2. 字符类：只为关键字中出现的字节分配类，大写字母与小写共用一类，转移表因此很小
+    std::fill(std::begin(m_classOf), std::end(m_classOf), uint8_t(0));
+    m_classCount = 1;
+    m_patterns.clear();
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        for (size_t bit = 0; bit < m_order[g].size(); ++bit) {
+            for (const Keyword& keyword : m_categories[g][m_order[g][bit]].keywords) {
+                for (char c : keyword.text) {
+                    const unsigned char byte = static_cast<unsigned char>(c);
+                    if (m_classOf[byte] != 0) continue;
+                    if (m_classCount >= 255) {
+                        std::cerr << "错误：分类关键字使用的字符种类过多" << std::endl;
+                        return false;
+                    }
+                    m_classOf[byte] = static_cast<uint8_t>(m_classCount);
+                    if (byte >= 'a' && byte <= 'z') m_classOf[byte - 'a' + 'A'] = static_cast<uint8_t>(m_classCount);
+                    ++m_classCount;
+                }
+                Pattern pattern;
+                pattern.group = static_cast<uint8_t>(g);
+                pattern.category = static_cast<uint8_t>(bit);
+                pattern.wordStart = keyword.wordStart ? 1 : 0;
+                pattern.length = static_cast<uint32_t>(keyword.text.size());
+                m_patterns.push_back(pattern);
+            }
+        }
+    }
+
+    // 3. 关键字插入字典树
+    std::vector<int32_t> trie(m_classCount, -1);
+    std::vector<std::vector<uint16_t>> outputs(1);
+    size_t pattern_index = 0;
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        for (size_t bit = 0; bit < m_order[g].size(); ++bit) {
+            for (const Keyword& keyword : m_categories[g][m_order[g][bit]].keywords) {
+                size_t state = 0;
+                for (char c : keyword.text) {
+                    const size_t cls = m_classOf[static_cast<unsigned char>(c)];
+                    if (trie[state * m_classCount + cls] < 0) {
+                        trie[state * m_classCount + cls] = static_cast<int32_t>(outputs.size());
+                        trie.resize(trie.size() + m_classCount, -1);
+                        outputs.emplace_back();
+                    }
+                    state = static_cast<size_t>(trie[state * m_classCount + cls]);
+                }
+                outputs[state].push_back(static_cast<uint16_t>(pattern_index++));
+            }
+        }
+    }
+
+    const size_t state_count = outputs.size();
+    if (state_count > 0xFFFF || m_patterns.size() > 0xFFFF) {
+        std::cerr << "错误：分类关键字过多，自动机状态超出上限" << std::endl;
+        return false;
+    }
+
+    // 4. 按层次遍历计算失败链，补全为完整 DFA，并沿失败链合并输出
+    m_delta.assign(state_count * m_classCount, 0);
+    std::vector<uint16_t> fail(state_count, 0);
+    std::queue<size_t> pending;
+    for (size_t cls = 0; cls < m_classCount; ++cls) {
+        const int32_t next = trie[cls];
+        if (next > 0) {
+            m_delta[cls] = static_cast<uint16_t>(next);
+            pending.push(static_cast<size_t>(next));
+        }
+    }
+    while (!pending.empty()) {
+        const size_t state = pending.front();
+        pending.pop();
+        const std::vector<uint16_t>& inherited = outputs[fail[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+        for (size_t cls = 0; cls < m_classCount; ++cls) {
+            const int32_t next = trie[state * m_classCount + cls];
+            const uint16_t fallback = m_delta[fail[state] * m_classCount + cls];
+            if (next > 0) {
+                fail[next] = fallback;
+                m_delta[state * m_classCount + cls] = static_cast<uint16_t>(next);
+                pending.push(static_cast<size_t>(next));
+            } else {
+                m_delta[state * m_classCount + cls] = fallback;
+            }
+        }
+    }
+
+    m_outBegin.assign(state_count + 1, 0);
+    m_outputs.clear();
+    for (size_t state = 0; state < state_count; ++state) {
+        m_outBegin[state] = static_cast<uint32_t>(m_outputs.size());
+        m_outputs.insert(m_outputs.end(), outputs[state].begin(), outputs[state].end());
+    }
+    m_outBegin[state_count] = static_cast<uint32_t>(m_outputs.size());
+    return true;
+}
+
+size_t AnimRuleMatcher::match(std::string_view text, Hits& hits, size_t from, size_t state) const
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t length = text.size();
+    for (size_t i = from; i < length; ++i) {
+        state = m_delta[state * m_classCount + m_classOf[bytes[i]]];
+        const uint32_t begin = m_outBegin[state];
+        const uint32_t end = m_outBegin[state + 1];
+        for (uint32_t o = begin; o < end; ++o) {
+            const Pattern& pattern = m_patterns[m_outputs[o]];
+            if (pattern.wordStart) {
+                const size_t start = i + 1 - pattern.length;
+                if (start > 0 && StringKernels::isWordChar(bytes[start - 1])) continue;
+            }
+            hits.bits[pattern.group] |= uint64_t(1) << pattern.category;
+        }
+    }
+    return state;
+}
+
+std::string AnimRuleMatcher::format(RuleGroup group, const Hits& hits) const
+{
+    const size_t g = static_cast<size_t>(group);
+    uint64_t bits = hits.bits[g];
+    std::string result;
+    while (bits != 0) {
+        const unsigned bit = StringKernels::lowestBit(bits);
+        if (!result.empty()) result += "; ";
+        result += m_categories[g][m_order[g][bit]].name;
+        if (is_first_match_group(g)) break;
+        bits &= bits - 1;
+    }
+    return result;
+}
+
+size_t AnimRuleMatcher::categoryCount(RuleGroup group) const
+{
+    return m_order[static_cast<size_t>(group)].size();
+}
+
+const std::string& AnimRuleMatcher::categoryName(RuleGroup group, size_t id) const
+{
+    const size_t g = static_cast<size_t>(group);
+    return m_categories[g][m_order[g][id]].name;
+}
+
+bool AnimRuleMatcher::loadRulesFile(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "错误：无法打开分类规则文件 -> " << path << std::endl;
+        return false;
+    }
+
+    AnimRuleMatcher loaded;
+    int group = -1;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            const std::string name = trim(line.substr(1, line.size() - 2));
+            group = -1;
+            for (size_t g = 0; g < kRuleGroupCount; ++g) {
+                if (name == kGroupNames[g]) group = static_cast<int>(g);
+            }
+            if (group < 0) {
+                std::cerr << "错误：分类规则文件第 " << line_number << " 行，未知的规则组 -> " << name << std::endl;
+                return false;
+            }
+            continue;
+        }
+        if (group < 0) {
+            std::cerr << "错误：分类规则文件第 " << line_number << " 行不属于任何规则组" << std::endl;
+            return false;
+        }
+
+        const size_t eq = line.find('=');
+        const std::string category = trim(eq == std::string::npos ? line : line.substr(0, eq));
+        const std::string keywords = eq == std::string::npos ? category : line.substr(eq + 1);
+        if (category.empty() || !loaded.addPattern(static_cast<RuleGroup>(group), category, keywords)) {
+            std::cerr << "错误：分类规则文件第 " << line_number << " 行格式错误" << std::endl;
+            return false;
+        }
+    }
+
+    if (!loaded.compile()) return false;
+    *this = std::move(loaded);
+    return true;
+}
+
+bool AnimRuleMatcher::saveRulesFile(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "错误：无法写入分类规则文件 -> " << path << std::endl;
+        return false;
+    }
+
+    file << "# 分类规则：分类 = 关键字1|关键字2，关键字前加 \\b 表示要求单词边界，匹配不区分大小写\n";
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        file << "\n[" << kGroupNames[g] << "]\n";
+        for (const Category& category : m_categories[g]) {
+            file << category.name << " = ";
+            for (size_t k = 0; k < category.keywords.size(); ++k) {
+                if (k > 0) file << '|';
+                if (category.keywords[k].wordStart) file << "\\b";
+                file << category.keywords[k].text;
+            }
+            file << '\n';
+        }
+    }
+    return file.good();
+}
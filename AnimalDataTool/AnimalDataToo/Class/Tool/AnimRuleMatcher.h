@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 分类规则组，对应 CSV 中的 体型/动作类型/场景类型/武器类型/义体类型/特殊标签 列
+enum class RuleGroup : uint8_t
+{
+    Body,
+    Action,
+    Scene,
+    Weapon,
+    Cyberware,
+    Tag,
+};
+
+const size_t kRuleGroupCount = 6;
+
+// 多模式分类匹配器：所有分类关键字编译成一个不区分大小写的 Aho-Corasick 自动机（完整 DFA 转移表），
+// 对路径只扫描一遍即可得到全部命中的分类。关键字前加 \b 表示要求其前面是单词边界
+// （与 std::regex 的 \b 一致：单词字符为 [A-Za-z0-9_]）。
+// 输出顺序与原正则/关键字列表实现一致：
+//   体型/动作/场景：所有命中的分类按名称排序，以 "; " 连接
+//   武器/义体：只取规则顺序中第一个命中的分类
+//   特殊标签：所有命中的标签按规则顺序，以 "; " 连接
+class AnimRuleMatcher
+{
+public:
+    // 每组最多 64 个分类，命中结果用位图表示
+    struct Hits
+    {
+        uint64_t bits[kRuleGroupCount] = {};
+    };
+
+    AnimRuleMatcher();
+
+    void clear();
+
+    // keywords 以 '|' 分隔；同一分类多次添加时关键字合并。添加后需要调用 compile()
+    bool addPattern(RuleGroup group, const std::string& category, const std::string& keywords);
+    bool compile();
+
+    // 从 text[from] 开始、以自动机状态 state 继续匹配，命中结果并入 hits，返回读完 text 后的状态。
+    // from 之前的字节只用于判断 \b；用前缀的返回状态继续匹配后缀，结果与整体匹配完全相同
+    size_t match(std::string_view text, Hits& hits, size_t from = 0, size_t state = 0) const;
+    std::string format(RuleGroup group, const Hits& hits) const;
+
+    size_t categoryCount(RuleGroup group) const;
+    // id 为位图中的位序号
+    const std::string& categoryName(RuleGroup group, size_t id) const;
+
+    // 规则文件：[body] [action] [scene] [weapon] [cyberware] [tag] 分节，每行 "分类 = 关键字1|关键字2"，
+    // 只有一个与分类同名的关键字时可以只写分类名；# 开头为注释。加载失败时保留原有规则
+    bool loadRulesFile(const std::string& path);
+    bool saveRulesFile(const std::string& path) const;
+
+private:
+    struct Keyword
+    {
+        std::string text;  // 小写
+        bool wordStart = false;
+    };
+
+    struct Category
+    {
+        std::string name;
+        std::vector<Keyword> keywords;
+    };
+
+    struct Pattern
+    {
+        uint8_t group;
+        uint8_t category;
+        uint8_t wordStart;
+        uint32_t length;
+    };
+
+    std::vector<Category> m_categories[kRuleGroupCount];  // 添加顺序
+    std::vector<uint8_t> m_order[kRuleGroupCount];        // 位序号 -> m_categories 下标
+
+    // 编译结果
+    uint8_t m_classOf[256] = {};     // 字节 -> 字符类（大小写映射到同一类，未出现的字节为 0）
+    size_t m_classCount = 1;
+    std::vector<uint16_t> m_delta;   // 状态 * m_classCount + 字符类 -> 下一状态
+    std::vector<uint32_t> m_outBegin;
+    std::vector<uint16_t> m_outputs; // 每个状态命中的 Pattern 下标（已沿失败链合并）
+    std::vector<Pattern> m_patterns;
+};
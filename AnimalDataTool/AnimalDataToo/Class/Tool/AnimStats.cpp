@@ -0,0 +1,543 @@
+﻿#include "AnimStats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "AnimGroup.h"
+#include "CompactRow.h"
+#include "StringKernels.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    const uint32_t kEmptyCode = 0xFFFFFFFFu;
+    const size_t kStatsChunkRows = 16384;
+
+    struct ColumnInfo
+    {
+        StatColumn column;
+        const char* name;   // 命令行/JSON 名称
+        const char* title;  // CSV/控制台名称（与分类 CSV 的列名一致）
+    };
+
+    const ColumnInfo kColumns[] = {
+        {StatColumn::TopCategory, "top", "顶级分类"},
+        {StatColumn::SubCategory, "sub", "子分类"},
+        {StatColumn::BodyType, "body", "体型"},
+        {StatColumn::ActionType, "action", "动作类型"},
+        {StatColumn::SceneType, "scene", "场景类型"},
+        {StatColumn::WeaponType, "weapon", "武器类型"},
+        {StatColumn::CyberwareType, "cyberware", "义体类型"},
+        {StatColumn::CharacterPrefix, "prefix", "角色前缀"},
+        {StatColumn::SpecialTags, "tag", "特殊标签"},
+        {StatColumn::Depth, "depth", "深度"},
+    };
+
+    // 分组键为 width 个 uint32 编码的开放寻址（线性探测）哈希表，计数为 0 的槽位为空
+    class GroupHashTable
+    {
+    public:
+        explicit GroupHashTable(size_t width)
+            : m_width(width)
+        {
+            rehash(64);
+        }
+
+        void add(const uint32_t* key, uint64_t count)
+        {
+            if ((m_size + 1) * 2 > m_capacity) rehash(m_capacity * 2);
+            insert(key, count);
+        }
+
+        template <typename Visit>
+        void forEach(Visit visit) const
+        {
+            for (size_t slot = 0; slot < m_capacity; ++slot) {
+                if (m_counts[slot] != 0) visit(&m_keys[slot * m_width], m_counts[slot]);
+            }
+        }
+
+    private:
+        uint64_t hash(const uint32_t* key) const
+        {
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (size_t i = 0; i < m_width; ++i) {
+                h = (h ^ key[i]) * 0xFF51AFD7ED558CCDull;
+                h ^= h >> 32;
+            }
+            return h;
+        }
+
+        void insert(const uint32_t* key, uint64_t count)
+        {
+            const size_t mask = m_capacity - 1;
+            size_t slot = static_cast<size_t>(hash(key)) & mask;
+            while (m_counts[slot] != 0) {
+                if (std::equal(key, key + m_width, &m_keys[slot * m_width])) {
+                    m_counts[slot] += count;
+                    return;
+                }
+                slot = (slot + 1) & mask;
+            }
+            std::copy(key, key + m_width, &m_keys[slot * m_width]);
+            m_counts[slot] = count;
+            ++m_size;
+        }
+
+        void rehash(size_t capacity)
+        {
+            std::vector<uint32_t> keys(capacity * m_width);
+            std::vector<uint64_t> counts(capacity, 0);
+            keys.swap(m_keys);
+            counts.swap(m_counts);
+            const size_t old_capacity = m_capacity;
+            m_capacity = capacity;
+            m_size = 0;
+            for (size_t slot = 0; slot < old_capacity; ++slot) {
+                if (counts[slot] != 0) insert(&keys[slot * m_width], counts[slot]);
+            }
+        }
+
+        size_t m_width;
+        size_t m_capacity = 0;
+        size_t m_size = 0;
+        std::vector<uint32_t> m_keys;
+        std::vector<uint64_t> m_counts;
+    };
+
+    // 把每列的值编码展开为笛卡尔积写入表中；codes 中第 k 列的值从 k * kMaxStatValues 开始
+    void add_combinations(GroupHashTable& table, const uint32_t* codes, const size_t* counts, size_t width,
+                          uint32_t* key, size_t* index)
+    {
+        for (size_t k = 0; k < width; ++k) {
+            if (counts[k] == 0) return;
+            index[k] = 0;
+        }
+        while (true) {
+            for (size_t k = 0; k < width; ++k) key[k] = codes[k * kMaxStatValues + index[k]];
+            table.add(key, 1);
+            size_t k = width;
+            while (k > 0 && ++index[k - 1] == counts[k - 1]) {
+                index[k - 1] = 0;
+                --k;
+            }
+            if (k == 0) return;
+        }
+    }
+
+    size_t append_bits(uint64_t bits, uint32_t* codes)
+    {
+        size_t count = 0;
+        for (; bits != 0; bits &= bits - 1) codes[count++] = StringKernels::lowestBit(bits);
+        return count;
+    }
+
+    bool is_multi_value(StatColumn column)
+    {
+        return column == StatColumn::BodyType || column == StatColumn::ActionType ||
+               column == StatColumn::SceneType || column == StatColumn::SpecialTags;
+    }
+
+    const std::string& row_field(const CSVRow& row, StatColumn column)
+    {
+        switch (column) {
+        case StatColumn::TopCategory: return row.topCategory;
+        case StatColumn::SubCategory: return row.subCategory;
+        case StatColumn::BodyType: return row.bodyType;
+        case StatColumn::ActionType: return row.actionType;
+        case StatColumn::SceneType: return row.sceneType;
+        case StatColumn::WeaponType: return row.weaponType;
+        case StatColumn::CyberwareType: return row.cyberwareType;
+        case StatColumn::CharacterPrefix: return row.characterPrefix;
+        case StatColumn::SpecialTags: return row.specialTags;
+        case StatColumn::Depth: break;
+        }
+        return row.topCategory;
+    }
+
+    // 字符串列的编码字典
+    struct ColumnDictionary
+    {
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::string> values;
+
+        uint32_t intern(const std::string& value)
+        {
+            auto inserted = ids.emplace(value, static_cast<uint32_t>(values.size()));
+            if (inserted.second) values.push_back(value);
+            return inserted.first->second;
+        }
+    };
+
+    // 数量降序，数量相同时按值升序，结果与线程数无关
+    void sort_groups(AnimStatsResult& result)
+    {
+        std::sort(result.groups.begin(), result.groups.end(),
+                  [](const AnimStatsResult::Group& a, const AnimStatsResult::Group& b) {
+                      if (a.count != b.count) return a.count > b.count;
+                      return a.values < b.values;
+                  });
+    }
+
+    std::string json_escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            const unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+                escaped.push_back(c);
+            } else if (byte < 0x20) {
+                const char* hex = "0123456789abcdef";
+                escaped += "\\u00";
+                escaped.push_back(hex[byte >> 4]);
+                escaped.push_back(hex[byte & 0xF]);
+            } else {
+                escaped.push_back(c);
+            }
+        }
+        return escaped;
+    }
+
+    std::string join_values(const std::vector<std::string>& values)
+    {
+        std::string text;
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) text += " × ";
+            text += values[i];
+        }
+        return text;
+    }
+
+    // 两列结果的交叉表：行、列都按合计降序，第二列的不同值过多时不输出
+    void print_cross_tab(std::ostream& out, const AnimStatsResult& result)
+    {
+        const size_t kMaxCrossTabColumns = 16;
+        std::vector<std::pair<std::string, uint64_t>> rows;
+        std::vector<std::pair<std::string, uint64_t>> cols;
+        const auto accumulate = [](std::vector<std::pair<std::string, uint64_t>>& totals, const std::string& value,
+                                   uint64_t count) {
+            for (auto& entry : totals) {
+                if (entry.first == value) {
+                    entry.second += count;
+                    return;
+                }
+            }
+            totals.emplace_back(value, count);
+        };
+        for (const AnimStatsResult::Group& group : result.groups) {
+            accumulate(rows, group.values[0], group.count);
+            accumulate(cols, group.values[1], group.count);
+            if (cols.size() > kMaxCrossTabColumns) return;
+        }
+        // groups 已按数量降序，第一次出现的顺序即按合计粗排，这里再精确排序
+        const auto by_total = [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        };
+        std::sort(rows.begin(), rows.end(), by_total);
+        std::sort(cols.begin(), cols.end(), by_total);
+
+        std::unordered_map<std::string, size_t> col_index;
+        for (size_t c = 0; c < cols.size(); ++c) col_index[cols[c].first] = c;
+        std::unordered_map<std::string, std::vector<uint64_t>> cells;
+        for (const AnimStatsResult::Group& group : result.groups) {
+            std::vector<uint64_t>& line = cells[group.values[0]];
+            line.resize(cols.size(), 0);
+            line[col_index[group.values[1]]] += group.count;
+        }
+
+        out << "\n  " << std::left << std::setw(25) << statColumnTitle(result.columns[0]);
+        for (const auto& col : cols) {
+            out << ' ' << std::right << std::setw(std::max<int>(8, static_cast<int>(col.first.size()))) << col.first;
+        }
+        out << "\n";
+        for (const auto& row : rows) {
+            out << "  " << std::left << std::setw(25) << row.first;
+            const std::vector<uint64_t>& line = cells[row.first];
+            for (size_t c = 0; c < cols.size(); ++c) {
+                out << ' ' << std::right << std::setw(std::max<int>(8, static_cast<int>(cols[c].first.size())))
+                    << line[c];
+            }
+            out << "\n";
+        }
+    }
+}
+
+const char* statColumnName(StatColumn column)
+{
+    return kColumns[static_cast<size_t>(column)].name;
+}
+
+const char* statColumnTitle(StatColumn column)
+{
+    return kColumns[static_cast<size_t>(column)].title;
+}
+
+bool parseStatColumns(const std::string& spec, std::vector<StatColumn>& columns)
+{
+    columns.clear();
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = spec.find(',', begin);
+        if (end == std::string::npos) end = spec.size();
+        const std::string name = spec.substr(begin, end - begin);
+        const ColumnInfo* found = nullptr;
+        for (const ColumnInfo& info : kColumns) {
+            if (name == info.name) found = &info;
+        }
+        if (!found) {
+            std::cerr << "错误：未知的统计列 -> " << name << std::endl;
+            return false;
+        }
+        columns.push_back(found->column);
+        begin = end + 1;
+    }
+    return !columns.empty();
+}
+
+size_t statColumnCodes(const CompactRow& row, StatColumn column, uint32_t* codes)
+{
+    switch (column) {
+    case StatColumn::TopCategory:
+        codes[0] = row.topCategory;
+        return row.topCategory != 0 ? 1 : 0;
+    case StatColumn::SubCategory:
+        codes[0] = row.subCategory;
+        return row.subCategory != 0 ? 1 : 0;
+    case StatColumn::BodyType: return append_bits(row.bodyBits, codes);
+    case StatColumn::ActionType: return append_bits(row.actionBits, codes);
+    case StatColumn::SceneType: return append_bits(row.sceneBits, codes);
+    case StatColumn::SpecialTags: return append_bits(row.tagBits, codes);
+    case StatColumn::WeaponType:
+        codes[0] = row.weapon - 1u;
+        return row.weapon != 0 ? 1 : 0;
+    case StatColumn::CyberwareType:
+        codes[0] = row.cyberware - 1u;
+        return row.cyberware != 0 ? 1 : 0;
+    case StatColumn::CharacterPrefix:
+        codes[0] = row.characterPrefix - 1u;
+        return row.characterPrefix != 0 ? 1 : 0;
+    case StatColumn::Depth:
+        codes[0] = row.depth;
+        return 1;
+    }
+    return 0;
+}
+
+std::string statColumnLabel(const CompactRowTable& table, StatColumn column, uint32_t code)
+{
+    if (code == kEmptyCode) return std::string();
+    switch (column) {
+    case StatColumn::TopCategory:
+    case StatColumn::SubCategory: return table.categoryName(code);
+    case StatColumn::BodyType: return table.ruleName(RuleGroup::Body, code);
+    case StatColumn::ActionType: return table.ruleName(RuleGroup::Action, code);
+    case StatColumn::SceneType: return table.ruleName(RuleGroup::Scene, code);
+    case StatColumn::WeaponType: return table.ruleName(RuleGroup::Weapon, code);
+    case StatColumn::CyberwareType: return table.ruleName(RuleGroup::Cyberware, code);
+    case StatColumn::SpecialTags: return table.ruleName(RuleGroup::Tag, code);
+    case StatColumn::CharacterPrefix: return table.characterPrefixName(static_cast<uint8_t>(code + 1));
+    case StatColumn::Depth: return std::to_string(code);
+    }
+    return std::string();
+}
+
+size_t statColumnValues(const CSVRow& row, StatColumn column, std::vector<std::string>& values)
+{
+    size_t count = 0;
+    const auto push = [&values, &count](const std::string& text, size_t begin, size_t size) {
+        if (count == values.size()) values.emplace_back();
+        values[count++].assign(text, begin, size);
+    };
+    if (column == StatColumn::Depth) {
+        const std::string depth = std::to_string(row.depth);
+        push(depth, 0, depth.size());
+        return count;
+    }
+    const std::string& field = row_field(row, column);
+    if (!is_multi_value(column)) {
+        if (!field.empty()) push(field, 0, field.size());
+        return count;
+    }
+    size_t begin = 0;
+    while (begin < field.size() && count < kMaxStatValues) {
+        size_t end = field.find(';', begin);
+        if (end == std::string::npos) end = field.size();
+        const size_t first = field.find_first_not_of(' ', begin);
+        if (first < end) {
+            const size_t last = field.find_last_not_of(' ', end - 1);
+            push(field, first, last + 1 - first);
+        }
+        begin = end + 1;
+    }
+    return count;
+}
+
+AnimStatsEngine::AnimStatsEngine(size_t thread_count)
+    : m_threadCount(thread_count)
+{
+}
+
+void AnimStatsEngine::setIncludeEmpty(bool include_empty)
+{
+    m_includeEmpty = include_empty;
+}
+
+AnimStatsResult AnimStatsEngine::groupBy(const CompactRowTable& table, const std::vector<StatColumn>& columns) const
+{
+    AnimStatsResult result;
+    result.columns = columns;
+    if (columns.empty()) return result;
+
+    const size_t width = columns.size();
+    const bool include_empty = m_includeEmpty;
+    const auto aggregate = [&table, &columns, width, include_empty](GroupHashTable& partial, size_t begin,
+                                                                   size_t end) {
+        std::vector<uint32_t> codes(width * kMaxStatValues);
+        std::vector<size_t> counts(width);
+        std::vector<uint32_t> key(width);
+        std::vector<size_t> index(width);
+        for (size_t i = begin; i < end; ++i) {
+            const CompactRow& row = table.row(i);
+            for (size_t k = 0; k < width; ++k) {
+                uint32_t* column_codes = &codes[k * kMaxStatValues];
+                counts[k] = statColumnCodes(row, columns[k], column_codes);
+                if (counts[k] == 0 && include_empty) {
+                    column_codes[0] = kEmptyCode;
+                    counts[k] = 1;
+                }
+            }
+            add_combinations(partial, codes.data(), counts.data(), width, key.data(), index.data());
+        }
+    };
+
+    size_t thread_count = m_threadCount != 0 ? m_threadCount : std::thread::hardware_concurrency();
+    std::vector<GroupHashTable> partials(1, GroupHashTable(width));
+    if (thread_count <= 1 || table.size() < 2 * kStatsChunkRows) {
+        aggregate(partials[0], 0, table.size());
+    } else {
+        // 每个工作线程聚合到自己的局部表，同一线程上的任务串行执行，无需加锁
+        partials.assign(thread_count, GroupHashTable(width));
+        WorkStealingPool pool(thread_count);
+        for (size_t begin = 0; begin < table.size(); begin += kStatsChunkRows) {
+            const size_t end = std::min(table.size(), begin + kStatsChunkRows);
+            pool.submit([&pool, &partials, &aggregate, begin, end] {
+                aggregate(partials[static_cast<size_t>(pool.worker_index())], begin, end);
+            });
+        }
+        pool.wait();
+        for (size_t p = 1; p < partials.size(); ++p) {
+            partials[p].forEach([&partials](const uint32_t* key, uint64_t count) { partials[0].add(key, count); });
+        }
+    }
+
+    partials[0].forEach([&](const uint32_t* key, uint64_t count) {
+        AnimStatsResult::Group group;
+        group.values.reserve(width);
+        for (size_t k = 0; k < width; ++k) group.values.push_back(statColumnLabel(table, columns[k], key[k]));
+        group.count = count;
+        result.total += count;
+        result.groups.push_back(std::move(group));
+    });
+    sort_groups(result);
+    return result;
+}
+
+AnimStatsResult AnimStatsEngine::groupBy(const std::vector<CSVRow>& rows, const std::vector<StatColumn>& columns) const
+{
+    AnimStatsResult result;
+    result.columns = columns;
+    if (columns.empty()) return result;
+
+    // 字符串需要先经过字典编码，字典是共享的，这里串行聚合
+    const size_t width = columns.size();
+    std::vector<ColumnDictionary> dictionaries(width);
+    GroupHashTable table(width);
+    std::vector<uint32_t> codes(width * kMaxStatValues);
+    std::vector<size_t> counts(width);
+    std::vector<uint32_t> key(width);
+    std::vector<size_t> index(width);
+    std::vector<std::string> values;
+    for (const CSVRow& row : rows) {
+        for (size_t k = 0; k < width; ++k) {
+            uint32_t* column_codes = &codes[k * kMaxStatValues];
+            counts[k] = 0;
+            const size_t value_count = statColumnValues(row, columns[k], values);
+            for (size_t v = 0; v < value_count; ++v) column_codes[counts[k]++] = dictionaries[k].intern(values[v]);
+            if (counts[k] == 0 && m_includeEmpty) {
+                column_codes[0] = kEmptyCode;
+                counts[k] = 1;
+            }
+        }
+        add_combinations(table, codes.data(), counts.data(), width, key.data(), index.data());
+    }
+
+    table.forEach([&](const uint32_t* group_key, uint64_t count) {
+        AnimStatsResult::Group group;
+        group.values.reserve(width);
+        for (size_t k = 0; k < width; ++k) {
+            group.values.push_back(group_key[k] == kEmptyCode ? std::string() : dictionaries[k].values[group_key[k]]);
+        }
+        group.count = count;
+        result.total += count;
+        result.groups.push_back(std::move(group));
+    });
+    sort_groups(result);
+    return result;
+}
+
+void AnimStatsEngine::printTable(std::ostream& out, const AnimStatsResult& result)
+{
+    std::vector<std::string> titles;
+    for (StatColumn column : result.columns) titles.push_back(statColumnTitle(column));
+    out << "\n【" << join_values(titles) << " 分布】\n";
+    for (const AnimStatsResult::Group& group : result.groups) {
+        out << "  " << std::left << std::setw(25) << join_values(group.values)
+            << ": " << std::right << std::setw(6) << group.count << "\n";
+    }
+    if (result.columns.size() == 2 && !result.groups.empty()) {
+        print_cross_tab(out, result);
+    }
+}
+
+void AnimStatsEngine::writeCsv(std::ostream& out, const AnimStatsResult& result)
+{
+    for (StatColumn column : result.columns) out << statColumnTitle(column) << ',';
+    out << "数量\n";
+    for (const AnimStatsResult::Group& group : result.groups) {
+        for (const std::string& value : group.values) out << escapeCSV(value) << ',';
+        out << group.count << '\n';
+    }
+}
+
+void AnimStatsEngine::writeJson(std::ostream& out, const AnimStatsResult& result)
+{
+    out << "{\"columns\":[";
+    for (size_t k = 0; k < result.columns.size(); ++k) {
+        if (k > 0) out << ',';
+        out << '"' << statColumnName(result.columns[k]) << '"';
+    }
+    out << "],\"total\":" << result.total << ",\"groups\":[";
+    for (size_t g = 0; g < result.groups.size(); ++g) {
+        if (g > 0) out << ',';
+        out << "{\"values\":[";
+        for (size_t k = 0; k < result.groups[g].values.size(); ++k) {
+            if (k > 0) out << ',';
+            out << '"' << json_escape(result.groups[g].values[k]) << '"';
+        }
+        out << "],\"count\":" << result.groups[g].count << '}';
+    }
+    out << "]}\n";
+}
+
+void AnimStatsEngine::write(std::ostream& out, const AnimStatsResult& result, AnimStatsFormat format)
+{
+    switch (format) {
+    case AnimStatsFormat::Console: printTable(out, result); break;
+    case AnimStatsFormat::Csv: writeCsv(out, result); break;
+    case AnimStatsFormat::Json: writeJson(out, result); break;
+    }
+}
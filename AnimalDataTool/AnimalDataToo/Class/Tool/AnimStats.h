@@ -0,0 +1,92 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class CompactRowTable;
+struct CompactRow;
+struct CSVRow;
+
+// 可分组统计的分类列。体型/动作/场景/特殊标签是多值列，一行会计入它的每个值
+enum class StatColumn : uint8_t
+{
+    TopCategory,
+    SubCategory,
+    BodyType,
+    ActionType,
+    SceneType,
+    WeaponType,
+    CyberwareType,
+    CharacterPrefix,
+    SpecialTags,
+    Depth,
+};
+
+enum class AnimStatsFormat
+{
+    Console,
+    Csv,
+    Json,
+};
+
+// 列的命令行名称：top, sub, body, action, scene, weapon, cyberware, prefix, tag, depth
+const char* statColumnName(StatColumn column);
+// 列的中文名称（与分类 CSV 的列名一致）
+const char* statColumnTitle(StatColumn column);
+// 解析以 ',' 分隔的列名，例如 "weapon,action"；有未知列名时报错并返回 false
+bool parseStatColumns(const std::string& spec, std::vector<StatColumn>& columns);
+
+// 一列最多的值个数（多值列为规则组的位图宽度）
+const size_t kMaxStatValues = 64;
+
+// 紧凑行某一列的值编码（分类ID、位序号、前缀序号或深度），写入 codes（至少 kMaxStatValues 个）并返回个数，空值返回 0
+size_t statColumnCodes(const CompactRow& row, StatColumn column, uint32_t* codes);
+// statColumnCodes 的编码对应的值
+std::string statColumnLabel(const CompactRowTable& table, StatColumn column, uint32_t code);
+// CSVRow 某一列的值写入 values 的前若干项并返回个数（复用其中字符串的容量）；
+// 多值列按 ';' 拆分并去掉空格，空值不计入
+size_t statColumnValues(const CSVRow& row, StatColumn column, std::vector<std::string>& values);
+
+// 分组统计结果，按数量降序、数量相同时按各列的值升序排列
+struct AnimStatsResult
+{
+    struct Group
+    {
+        std::vector<std::string> values;  // 与 columns 一一对应
+        uint64_t count;
+    };
+
+    std::vector<StatColumn> columns;
+    std::vector<Group> groups;
+    uint64_t total = 0;  // 所有分组的计数之和
+};
+
+// 分组统计引擎：每行先把各列的值编码为整数（紧凑表直接使用分类ID和位序号），
+// 多值列展开为笛卡尔积后写入开放寻址哈希表。行按块分给线程池，每个工作线程聚合到自己的局部表，
+// 最后合并局部表并把编码还原为字符串
+class AnimStatsEngine
+{
+public:
+    // thread_count 为 0 时使用硬件线程数
+    explicit AnimStatsEngine(size_t thread_count = 0);
+
+    // 为 false（默认）时某列值为空的行不计入，与原 printStatistics 一致；为 true 时空值作为一个分组
+    void setIncludeEmpty(bool include_empty);
+
+    AnimStatsResult groupBy(const CompactRowTable& table, const std::vector<StatColumn>& columns) const;
+    // CSVRow 的多值列按 ';' 拆分并去掉空格
+    AnimStatsResult groupBy(const std::vector<CSVRow>& rows, const std::vector<StatColumn>& columns) const;
+
+    // 控制台：每行 "  值 × 值 : 数量"；两列时再输出一张交叉表
+    static void printTable(std::ostream& out, const AnimStatsResult& result);
+    // CSV：表头为各列的中文列名和 数量
+    static void writeCsv(std::ostream& out, const AnimStatsResult& result);
+    static void writeJson(std::ostream& out, const AnimStatsResult& result);
+    static void write(std::ostream& out, const AnimStatsResult& result, AnimStatsFormat format);
+
+private:
+    size_t m_threadCount;
+    bool m_includeEmpty = false;
+};
@@ -0,0 +1,338 @@
+﻿#include "AnimWatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "ScanManifest.h"
+#include "WriteTool.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+namespace
+{
+    // 事件不断时 debounce 窗口会一直后移：从本批第一个事件起最多推迟 debounce 的这么多倍就强制处理
+    const int kMaxDelayFactor = 10;
+
+    bool has_anims_suffix(const char* name)
+    {
+        static const char suffix[] = ".anims";
+        const size_t suffix_len = sizeof(suffix) - 1;
+        const size_t len = std::strlen(name);
+        return len >= suffix_len && std::memcmp(name + len - suffix_len, suffix, suffix_len) == 0;
+    }
+}
+#endif
+
+AnimWatcher::AnimWatcher()
+{
+}
+
+AnimWatcher::~AnimWatcher()
+{
+#if defined(__linux__)
+    if (m_inotifyFd >= 0) ::close(m_inotifyFd);
+    if (m_wakeFd >= 0) ::close(m_wakeFd);
+#endif
+}
+
+void AnimWatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stopMutex);
+        m_stop = true;
+    }
+    m_stopCv.notify_all();
+#if defined(__linux__)
+    if (m_wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(m_wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+#endif
+}
+
+bool AnimWatcher::wait_for_stop(int timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(m_stopMutex);
+    return m_stopCv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return m_stop.load(); });
+}
+
+bool AnimWatcher::run(const std::string& root_folder, const std::string& root_csv_output_path,
+                      const std::vector<AnimCSVOutput>& outputs, int debounce_ms, int poll_interval_ms)
+{
+    if (!fs::exists(root_folder) || !fs::is_directory(root_folder)) {
+        std::cerr << "错误：文件夹不存在或不是目录 -> " << root_folder << std::endl;
+        return false;
+    }
+
+    m_rootFolder = root_folder;
+    m_rootCsvOutputPath = root_csv_output_path;
+    m_outputs = outputs;
+    m_debounceMs = debounce_ms;
+    m_pollIntervalMs = poll_interval_ms;
+    m_published = false;
+
+#if defined(__linux__)
+    return run_inotify();
+#else
+    return run_polling();
+#endif
+}
+
+// 只重写内容发生变化的 CSV（首次全部写出）
+void AnimWatcher::publish(const std::vector<std::string>& files)
+{
+    std::vector<std::vector<std::string>> routed = AnimGroupMethod::RouteByFolder(files, m_outputs);
+    WriteTool write_tool;
+    size_t rewritten = 0;
+
+    if (!m_published || files != m_lastRootFiles) {
+        write_tool.write_to_csv(files, m_rootCsvOutputPath);
+        ++rewritten;
+    }
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        if (!m_published || routed[i] != m_lastRouted[i]) {
+            write_tool.write_to_csv(routed[i], m_outputs[i].csv_output_path);
+            ++rewritten;
+        }
+    }
+
+    if (rewritten > 0) {
+        std::cout << "监视模式：当前 " << files.size() << " 个 .Animal 文件，重写 " << rewritten << " 个 CSV" << std::endl;
+    }
+    m_lastRootFiles = files;
+    m_lastRouted = std::move(routed);
+    m_published = true;
+}
+
+// 按目录项顺序先序展开索引，输出顺序与全量递归遍历一致
+void AnimWatcher::collect_files(const std::string& dir, std::vector<std::string>& out) const
+{
+    auto it = m_index.find(dir);
+    if (it == m_index.end()) return;
+    for (const FindAnim::DirItem& item : it->second.items) {
+        if (item.is_dir) {
+            collect_files(item.path.string(), out);
+        } else {
+            out.push_back(item.path.string());
+        }
+    }
+}
+
+// 列举并登记整棵子树；先注册监视再列举，避免漏掉两者之间新建的文件
+void AnimWatcher::scan_subtree(const fs::path& dir)
+{
+    const std::string key = dir.string();
+    DirState state;
+
+#if defined(__linux__)
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW;
+    state.wd = ::inotify_add_watch(m_inotifyFd, dir.c_str(), mask);
+    if (state.wd < 0) {
+        std::cerr << "警告：无法监视目录 -> " << key << " (" << std::strerror(errno) << ")";
+        if (errno == ENOSPC) {
+            std::cerr << "，请调大 /proc/sys/fs/inotify/max_user_watches";
+        }
+        std::cerr << std::endl;
+    } else {
+        // 目录被移动时 inotify 复用同一个描述符，这里以最新路径为准
+        m_watchDirs[state.wd] = key;
+    }
+#endif
+
+    if (!m_findAnim.list_directory(dir, state.items)) {
+        state.items.clear();
+    }
+    std::vector<fs::path> subdirs;
+    for (const FindAnim::DirItem& item : state.items) {
+        if (item.is_dir) subdirs.push_back(item.path);
+    }
+    m_index[key] = std::move(state);
+
+    for (const fs::path& subdir : subdirs) {
+        scan_subtree(subdir);
+    }
+}
+
+void AnimWatcher::remove_subtree(const std::string& dir)
+{
+    auto it = m_index.find(dir);
+    if (it == m_index.end()) return;
+
+    DirState state = std::move(it->second);
+    m_index.erase(it);
+    for (const FindAnim::DirItem& item : state.items) {
+        if (item.is_dir) remove_subtree(item.path.string());
+    }
+
+#if defined(__linux__)
+    // 描述符可能已被移动后的新路径接管，只释放仍属于本路径的监视
+    auto watch = m_watchDirs.find(state.wd);
+    if (watch != m_watchDirs.end() && watch->second == dir) {
+        ::inotify_rm_watch(m_inotifyFd, state.wd);
+        m_watchDirs.erase(watch);
+    }
+#endif
+}
+
+// 重新列举单个目录，对比前后的子目录集合，新增的子树登记、消失的子树移除
+void AnimWatcher::refresh_directory(const std::string& dir)
+{
+    auto it = m_index.find(dir);
+    if (it == m_index.end()) return;
+
+    std::vector<FindAnim::DirItem> items;
+    if (!m_findAnim.list_directory(fs::path(dir), items)) {
+        // 目录已不存在：父目录的事件会把它从索引里摘掉，这里先清空内容
+        items.clear();
+    }
+
+    std::unordered_set<std::string> old_subdirs;
+    for (const FindAnim::DirItem& item : it->second.items) {
+        if (item.is_dir) old_subdirs.insert(item.path.string());
+    }
+    std::vector<fs::path> added;
+    std::unordered_set<std::string> new_subdirs;
+    for (const FindAnim::DirItem& item : items) {
+        if (!item.is_dir) continue;
+        std::string key = item.path.string();
+        if (!old_subdirs.count(key)) added.push_back(item.path);
+        new_subdirs.insert(std::move(key));
+    }
+
+    it->second.items = std::move(items);
+    for (const std::string& old_dir : old_subdirs) {
+        if (!new_subdirs.count(old_dir)) remove_subtree(old_dir);
+    }
+    for (const fs::path& new_dir : added) {
+        scan_subtree(new_dir);
+    }
+}
+
+void AnimWatcher::apply_dirty_batch()
+{
+    // 父目录先处理：被移除的子树不必再重新列举
+    std::vector<std::string> dirty(m_dirty.begin(), m_dirty.end());
+    m_dirty.clear();
+    std::sort(dirty.begin(), dirty.end(),
+              [](const std::string& a, const std::string& b) { return a.size() < b.size() || (a.size() == b.size() && a < b); });
+    for (const std::string& dir : dirty) {
+        refresh_directory(dir);
+    }
+
+    std::vector<std::string> files;
+    collect_files(fs::path(m_rootFolder).string(), files);
+    publish(files);
+}
+
+#if defined(__linux__)
+void AnimWatcher::read_events()
+{
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while (true) {
+        ssize_t bytes = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (bytes <= 0) break;  // EAGAIN：本轮事件已读完
+
+        for (ssize_t offset = 0; offset < bytes;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // 事件队列溢出：无法知道丢了哪些事件，全部目录重新列举
+                std::cerr << "警告：inotify 事件队列溢出，重新列举全部目录" << std::endl;
+                for (const auto& dir : m_index) m_dirty.insert(dir.first);
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_watchDirs.erase(event->wd);
+                continue;
+            }
+
+            auto watch = m_watchDirs.find(event->wd);
+            if (watch == m_watchDirs.end() || event->len == 0) continue;
+            // 只关心子目录和 .anims 文件的增删，其他文件的变化不触发重写
+            if ((event->mask & IN_ISDIR) || has_anims_suffix(event->name)) {
+                m_dirty.insert(watch->second);
+            }
+        }
+    }
+}
+
+bool AnimWatcher::run_inotify()
+{
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotifyFd < 0 || m_wakeFd < 0) {
+        std::cerr << "错误：无法初始化 inotify (" << std::strerror(errno) << ")，改用定时增量扫描" << std::endl;
+        return run_polling();
+    }
+
+    scan_subtree(fs::path(m_rootFolder));
+    std::vector<std::string> files;
+    collect_files(fs::path(m_rootFolder).string(), files);
+    publish(files);
+    std::cout << "监视模式：已监视 " << m_watchDirs.size() << " 个目录，等待变化..." << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::milliseconds debounce(m_debounceMs);
+    const std::chrono::milliseconds max_delay(static_cast<long long>(m_debounceMs) * kMaxDelayFactor);
+    Clock::time_point last_event = Clock::now();
+    Clock::time_point first_event = last_event;  // 本批第一个待处理事件
+    while (!m_stop) {
+        // 没有待处理变化时无限期阻塞；有变化时等到 debounce 窗口结束或达到最长推迟时间
+        int timeout = -1;
+        if (!m_dirty.empty()) {
+            const Clock::time_point deadline = std::min(last_event + debounce, first_event + max_delay);
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, remaining));
+        }
+
+        struct pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+        int ready = ::poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "错误：poll 失败 (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        if (fds[1].revents & POLLIN) break;
+        if (fds[0].revents & POLLIN) {
+            const bool was_clean = m_dirty.empty();
+            read_events();
+            last_event = Clock::now();
+            if (was_clean) first_event = last_event;
+        }
+
+        if (!m_dirty.empty()) {
+            const Clock::time_point now = Clock::now();
+            if (now - last_event >= debounce || now - first_event >= max_delay) {
+                apply_dirty_batch();
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+// 无 inotify 时的退化实现：定时增量扫描，只在结果变化时重写 CSV
+bool AnimWatcher::run_polling()
+{
+    ScanManifest manifest;
+    std::vector<std::string> files = m_findAnim.find_animal_files_incremental(m_rootFolder, manifest);
+    publish(files);
+    std::cout << "监视模式：每 " << m_pollIntervalMs << " 毫秒增量扫描一次，等待变化..." << std::endl;
+
+    while (!wait_for_stop(m_pollIntervalMs)) {
+        files = m_findAnim.find_animal_files_incremental(m_rootFolder, manifest, false);
+        publish(files);
+    }
+    return true;
+}
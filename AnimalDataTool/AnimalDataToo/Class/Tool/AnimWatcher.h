@@ -0,0 +1,73 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AnimGroupMethod.h"
+#include "FindAnim.h"
+
+// 监视模式：首次全量扫描后常驻，增量维护内存中的目录索引，并只重写内容有变化的 CSV。
+// Linux 下对每个目录注册 inotify，空闲时阻塞在 poll 上不占 CPU；事件按 debounce 合并成批处理，
+// 事件持续不断时从本批第一个事件起最多推迟 debounce 的 10 倍。
+// 其他平台退化为定时增量扫描（复用 ScanManifest 的目录修改时间判断）。
+class AnimWatcher
+{
+public:
+    AnimWatcher();
+    ~AnimWatcher();
+
+    // 阻塞运行直到 stop() 被调用；初始化失败时返回 false
+    bool run(const std::string& root_folder, const std::string& root_csv_output_path,
+             const std::vector<AnimCSVOutput>& outputs, int debounce_ms = 500, int poll_interval_ms = 5000);
+
+    // 可在其他线程调用，通知 run() 退出
+    void stop();
+
+private:
+    struct DirState
+    {
+        std::vector<FindAnim::DirItem> items;  // 按目录项原始顺序
+        int wd = -1;                           // inotify 监视描述符
+    };
+
+    void scan_subtree(const fs::path& dir);
+    void remove_subtree(const std::string& dir);
+    void refresh_directory(const std::string& dir);
+    void apply_dirty_batch();
+    void collect_files(const std::string& dir, std::vector<std::string>& out) const;
+    void publish(const std::vector<std::string>& files);
+    bool wait_for_stop(int timeout_ms);
+
+#if defined(__linux__)
+    bool run_inotify();
+    void read_events();
+#endif
+    bool run_polling();
+
+    FindAnim m_findAnim;
+    std::string m_rootFolder;
+    std::string m_rootCsvOutputPath;
+    std::vector<AnimCSVOutput> m_outputs;
+    int m_debounceMs = 500;
+    int m_pollIntervalMs = 5000;
+
+    // 目录索引：目录路径 -> 列举结果，以及 inotify 描述符 -> 目录路径
+    std::unordered_map<std::string, DirState> m_index;
+    std::unordered_map<int, std::string> m_watchDirs;
+    std::unordered_set<std::string> m_dirty;
+
+    // 上次写出的内容，用于判断哪些 CSV 需要重写
+    std::vector<std::string> m_lastRootFiles;
+    std::vector<std::vector<std::string>> m_lastRouted;
+    bool m_published = false;
+
+    int m_inotifyFd = -1;
+    int m_wakeFd = -1;
+    std::atomic<bool> m_stop{false};
+    std::mutex m_stopMutex;
+    std::condition_variable m_stopCv;
+};
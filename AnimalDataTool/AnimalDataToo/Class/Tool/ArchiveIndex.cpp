@@ -0,0 +1,196 @@
+﻿#include "ArchiveIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // RDAR 文件格式（小端）：
+    //   文件头 40 字节：magic, version, indexPosition(u64), indexSize, debugPosition(u64), debugSize, fileSize(u64)
+    //   索引头 28 字节：fileTableOffset, fileTableSize, crc(u64), fileEntryCount, fileSegmentCount, dependencyCount
+    //   文件表项 56 字节：nameHash(u64), timestamp(u64), inlineBufferSegments, segmentsStart, segmentsEnd,
+    //                     dependenciesStart, dependenciesEnd, sha1[20]
+    //   分段 16 字节：offset(u64), zSize, size
+    const uint32_t kArchiveMagic = 0x52414452;  // "RDAR"
+    const size_t kHeaderSize = 40;
+    const size_t kIndexHeaderSize = 28;
+    const size_t kFileEntrySize = 56;
+    const size_t kSegmentSize = 16;
+
+    template <typename T>
+    T read_le(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    bool ends_with_anims(std::string_view path)
+    {
+        static const char suffix[] = ".anims";
+        const size_t suffix_len = sizeof(suffix) - 1;
+        if (path.size() < suffix_len) return false;
+        for (size_t i = 0; i < suffix_len; ++i) {
+            char c = path[path.size() - suffix_len + i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != suffix[i]) return false;
+        }
+        return true;
+    }
+}
+
+ArchiveIndex::ArchiveIndex()
+{
+}
+
+uint64_t ArchiveIndex::fnv1a64(std::string_view text)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+size_t ArchiveIndex::load_hash_list(const std::string& hash_list_path)
+{
+    std::ifstream file(hash_list_path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "错误：无法打开哈希列表 -> " << hash_list_path << std::endl;
+        return 0;
+    }
+
+    size_t loaded = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        std::string path = line;
+        uint64_t hash = 0;
+        bool has_hash = false;
+        size_t comma = line.rfind(',');
+        if (comma != std::string::npos) {
+            path = line.substr(0, comma);
+            const std::string hash_text = line.substr(comma + 1);
+            if (!hash_text.empty() && std::all_of(hash_text.begin(), hash_text.end(),
+                                                  [](char c) { return c >= '0' && c <= '9'; })) {
+                hash = std::stoull(hash_text);
+                has_hash = true;
+            } else {
+                continue;  // 表头或格式不符的行
+            }
+        }
+
+        if (!ends_with_anims(path)) continue;
+        if (!has_hash) hash = fnv1a64(path);
+        m_hashToPath[hash] = std::move(path);
+        ++loaded;
+    }
+
+    std::cout << "哈希列表：载入 " << loaded << " 个 .anims 路径" << std::endl;
+    return loaded;
+}
+
+bool ArchiveIndex::index_archive(const std::string& archive_path)
+{
+    MappedFile file;
+    if (!file.open(archive_path)) return false;
+
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    if (size < kHeaderSize || read_le<uint32_t>(data) != kArchiveMagic) {
+        std::cerr << "错误：不是有效的 archive 文件 -> " << archive_path << std::endl;
+        return false;
+    }
+
+    const uint64_t index_position = read_le<uint64_t>(data + 8);
+    if (index_position > size || size - index_position < kIndexHeaderSize) {
+        std::cerr << "错误：archive 索引位置越界 -> " << archive_path << std::endl;
+        return false;
+    }
+
+    const uint8_t* index = data + index_position;
+    const uint32_t file_count = read_le<uint32_t>(index + 16);
+    const uint32_t segment_count = read_le<uint32_t>(index + 20);
+    const uint64_t table_bytes = static_cast<uint64_t>(file_count) * kFileEntrySize +
+                                 static_cast<uint64_t>(segment_count) * kSegmentSize;
+    if (size - index_position - kIndexHeaderSize < table_bytes) {
+        std::cerr << "错误：archive 文件表越界 -> " << archive_path << std::endl;
+        return false;
+    }
+
+    const uint8_t* file_table = index + kIndexHeaderSize;
+    const uint8_t* segments = file_table + static_cast<size_t>(file_count) * kFileEntrySize;
+    const uint32_t archive_id = static_cast<uint32_t>(m_archives.size());
+    m_archives.push_back(archive_path);
+
+    size_t found = 0;
+    for (uint32_t i = 0; i < file_count; ++i) {
+        const uint8_t* entry = file_table + static_cast<size_t>(i) * kFileEntrySize;
+        const uint64_t hash = read_le<uint64_t>(entry);
+
+        auto it = m_hashToPath.find(hash);
+        if (it == m_hashToPath.end()) {
+            ++m_unresolved;
+            continue;
+        }
+        if (!m_seen.insert(hash).second) continue;
+
+        ArchiveAnimEntry anim;
+        anim.path = it->second;
+        anim.hash = hash;
+        anim.archive = archive_id;
+        const uint32_t segments_start = read_le<uint32_t>(entry + 20);
+        const uint32_t segments_end = read_le<uint32_t>(entry + 24);
+        for (uint32_t s = segments_start; s < segments_end && s < segment_count; ++s) {
+            anim.size += read_le<uint32_t>(segments + static_cast<size_t>(s) * kSegmentSize + 12);
+        }
+        m_entries.push_back(std::move(anim));
+        ++found;
+    }
+
+    std::cout << "archive：" << archive_path << "，" << file_count << " 个条目，其中 "
+              << found << " 个 .anims" << std::endl;
+    return true;
+}
+
+size_t ArchiveIndex::index_folder(const std::string& folder)
+{
+    std::vector<std::string> archive_paths;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(folder, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && it->path().extension() == ".archive") {
+            archive_paths.push_back(it->path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "错误：无法遍历 archive 目录 -> " << folder << " (" << ec.message() << ")" << std::endl;
+    }
+
+    std::sort(archive_paths.begin(), archive_paths.end());
+    size_t indexed = 0;
+    for (const std::string& archive_path : archive_paths) {
+        if (index_archive(archive_path)) ++indexed;
+    }
+    return indexed;
+}
+
+std::vector<std::string> ArchiveIndex::sorted_paths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(m_entries.size());
+    for (const ArchiveAnimEntry& entry : m_entries) {
+        paths.push_back(entry.path);
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
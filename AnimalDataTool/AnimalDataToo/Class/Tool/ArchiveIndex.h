@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 直接索引游戏打包的 .archive（RDAR）容器：内存映射后只读取文件头和文件表，
+// 用用户提供的 哈希→路径 列表把 64 位路径哈希还原成 .anims 路径，无需解包
+struct ArchiveAnimEntry
+{
+    std::string path;        // 仓库内路径，例如 base\animations\...\xxx.anims
+    uint64_t hash = 0;       // FNV-1a 64 路径哈希
+    uint32_t archive = 0;    // 所在 archive 在 archives() 中的下标
+    uint64_t size = 0;       // 解压后大小（各分段之和）
+};
+
+class ArchiveIndex
+{
+public:
+    ArchiveIndex();
+
+    // 读取哈希列表：每行 "路径" 或 "路径,哈希"（兼容 WolvenKit 的 archivehashes.csv），只保留 .anims 路径
+    size_t load_hash_list(const std::string& hash_list_path);
+
+    // 索引单个 archive；同一哈希只记录第一次出现的条目
+    bool index_archive(const std::string& archive_path);
+
+    // 递归查找目录下所有 .archive 并按路径排序后依次索引，返回成功索引的 archive 数
+    size_t index_folder(const std::string& folder);
+
+    const std::vector<ArchiveAnimEntry>& entries() const { return m_entries; }
+    const std::vector<std::string>& archives() const { return m_archives; }
+    // 文件表中没有出现在哈希列表里的条目数（无法判断是否为 .anims）
+    size_t unresolved_count() const { return m_unresolved; }
+
+    // 按路径排序后的 .anims 路径
+    std::vector<std::string> sorted_paths() const;
+
+    static uint64_t fnv1a64(std::string_view text);
+
+private:
+    std::unordered_map<uint64_t, std::string> m_hashToPath;
+    std::unordered_set<uint64_t> m_seen;
+    std::vector<ArchiveAnimEntry> m_entries;
+    std::vector<std::string> m_archives;
+    size_t m_unresolved = 0;
+};
@@ -0,0 +1,116 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 单生产者/单消费者有界无锁环形队列，用于流水线各阶段之间传递数据。
+// 队列满/空时先自旋，再让出时间片，最后短暂休眠；生产者结束后调用 close()。
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const { return m_slots.size(); }
+
+    // 近似的当前元素个数（两端并发修改时只是一个快照）
+    size_t size_approx() const
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool try_push(T& value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache >= m_slots.size()) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache >= m_slots.size()) return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 阻塞写入（仅生产者线程调用）
+    void push(T value)
+    {
+        if (try_push(value)) return;
+        ++m_pushStalls;
+        for (unsigned spin = 0; !try_push(value); ++spin) {
+            backoff(spin);
+        }
+    }
+
+    // 阻塞读取（仅消费者线程调用）；队列已关闭且读空时返回 false
+    bool pop(T& value)
+    {
+        if (try_pop(value)) return true;
+        ++m_popStalls;
+        for (unsigned spin = 0;; ++spin) {
+            if (try_pop(value)) return true;
+            if (m_closed.load(std::memory_order_acquire)) {
+                // close 之前写入的元素在 close 之后一定可见，再读一次
+                return try_pop(value);
+            }
+            backoff(spin);
+        }
+    }
+
+    void close() { m_closed.store(true, std::memory_order_release); }
+
+    // 队列满/空导致等待的次数，分别只由生产者/消费者线程修改，流水线结束后读取
+    size_t push_stalls() const { return m_pushStalls; }
+    size_t pop_stalls() const { return m_popStalls; }
+
+private:
+    static void backoff(unsigned spin)
+    {
+        if (spin < 64) {
+            // 忙等
+        } else if (spin < 256) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    std::vector<T> m_slots;
+    size_t m_mask = 0;
+
+    // 生产者、消费者各自的下标放在不同缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_tailCache = 0;
+    size_t m_popStalls = 0;
+
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_headCache = 0;
+    size_t m_pushStalls = 0;
+
+    alignas(64) std::atomic<bool> m_closed{false};
+};
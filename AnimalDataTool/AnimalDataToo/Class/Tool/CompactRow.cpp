@@ -0,0 +1,264 @@
+﻿#include "CompactRow.h"
+#include "AnimGroup.h"
+#include "StringKernels.h"
+
+#include <iostream>
+
+namespace
+{
+    const size_t kMaxPathLength = 0xFFFF;
+
+    // 某一规则组的命中位图；武器/义体只保存第一个命中的位序号
+    uint64_t group_bits(const CompactRow& row, RuleGroup group)
+    {
+        switch (group) {
+        case RuleGroup::Body: return row.bodyBits;
+        case RuleGroup::Action: return row.actionBits;
+        case RuleGroup::Scene: return row.sceneBits;
+        case RuleGroup::Weapon: return row.weapon ? uint64_t(1) << (row.weapon - 1) : 0;
+        case RuleGroup::Cyberware: return row.cyberware ? uint64_t(1) << (row.cyberware - 1) : 0;
+        case RuleGroup::Tag: return row.tagBits;
+        }
+        return 0;
+    }
+
+    uint8_t first_bit_id(uint64_t bits)
+    {
+        return bits ? static_cast<uint8_t>(StringKernels::lowestBit(bits) + 1) : 0;
+    }
+
+    void store_hits(CompactRow& row, const AnimRuleMatcher::Hits& hits)
+    {
+        row.bodyBits = hits.bits[static_cast<size_t>(RuleGroup::Body)];
+        row.actionBits = hits.bits[static_cast<size_t>(RuleGroup::Action)];
+        row.sceneBits = hits.bits[static_cast<size_t>(RuleGroup::Scene)];
+        row.tagBits = hits.bits[static_cast<size_t>(RuleGroup::Tag)];
+        row.weapon = first_bit_id(hits.bits[static_cast<size_t>(RuleGroup::Weapon)]);
+        row.cyberware = first_bit_id(hits.bits[static_cast<size_t>(RuleGroup::Cyberware)]);
+    }
+}
+
+CompactRowTable::CompactRowTable(const AnimsClassifier& classifier)
+    : m_classifier(&classifier)
+{
+    for (size_t g = 0; g < kRuleGroupCount; ++g) {
+        const RuleGroup group = static_cast<RuleGroup>(g);
+        for (size_t bit = 0; bit < classifier.ruleCount(group); ++bit) {
+            m_ruleNames[g].push_back(classifier.ruleName(group, bit));
+        }
+    }
+    for (size_t id = 0; id < BuiltinAnimRules::characterPrefixCount(); ++id) {
+        m_prefixNames.push_back(BuiltinAnimRules::characterPrefixName(id));
+    }
+    clear();
+}
+
+void CompactRowTable::clear()
+{
+    m_rows.clear();
+    m_paths.clear();
+    m_categories.assign(1, std::string());
+    m_categoryIds.clear();
+    m_categoryIds.emplace(std::string(), 0);
+    m_dirCache.clear();
+    m_dirCategories.clear();
+}
+
+void CompactRowTable::reserve(size_t rows, size_t path_bytes)
+{
+    m_rows.reserve(rows);
+    m_paths.reserve(path_bytes);
+}
+
+uint32_t CompactRowTable::intern(std::string_view name)
+{
+    auto inserted = m_categoryIds.emplace(std::string(name), static_cast<uint32_t>(m_categories.size()));
+    if (inserted.second) m_categories.emplace_back(name);
+    return inserted.first->second;
+}
+
+bool CompactRowTable::add(std::string_view fullPath, std::string_view filename)
+{
+    if (fullPath.size() > kMaxPathLength || filename.size() > fullPath.size()) {
+        std::cerr << "错误：路径过长，无法写入紧凑分类表 -> " << fullPath << std::endl;
+        return false;
+    }
+
+    CompactRow row = {};
+    row.pathOffset = static_cast<uint32_t>(m_paths.size());
+    row.pathLength = static_cast<uint32_t>(fullPath.size());
+    row.nameOffset = static_cast<uint16_t>(fullPath.size() - filename.size());
+    m_paths.append(fullPath.data(), fullPath.size());
+
+    // 相对路径规则与 AnimsClassifier::extractRelativePath 相同
+    const size_t offset = AnimsClassifier::relativePathOffset(fullPath);
+    m_scratch.clear();
+    if (offset != std::string_view::npos) {
+        row.hasRelative = 1;
+        row.relOffset = static_cast<uint16_t>(offset);
+        m_scratch.append(fullPath.data() + row.relOffset, fullPath.size() - row.relOffset);
+        StringKernels::replaceByte(&m_scratch[0], m_scratch.size(), '\\', '/');
+    } else {
+        m_scratch.append(fullPath.data(), fullPath.size());
+    }
+    const std::string_view relative(m_scratch);
+
+    const size_t first = relative.find('/');
+    if (first != std::string_view::npos) {
+        row.topCategory = intern(relative.substr(0, first));
+        const size_t second = relative.find('/', first + 1);
+        if (second != std::string_view::npos) {
+            row.subCategory = intern(relative.substr(first + 1, second - first - 1));
+        }
+    }
+    row.depth = static_cast<uint16_t>(StringKernels::countByte(relative, '/'));
+
+    AnimRuleMatcher::Hits hits;
+    m_classifier->matchRules(relative, hits);
+    store_hits(row, hits);
+    row.characterPrefix = static_cast<uint8_t>(m_classifier->findCharacterPrefix(filename) + 1);
+
+    m_rows.push_back(row);
+    return true;
+}
+
+bool CompactRowTable::add(std::string_view fullPath, std::string_view filename, uint32_t dirId)
+{
+    if (fullPath.size() > kMaxPathLength || filename.size() > fullPath.size() ||
+        filename.find_first_of("\\/") != std::string_view::npos ||
+        fullPath.substr(fullPath.size() - filename.size()) != filename) {
+        return add(fullPath, filename);
+    }
+
+    const DirClassCache::Entry& dir =
+        m_dirCache.lookup(*m_classifier, dirId, fullPath.substr(0, fullPath.size() - filename.size()));
+
+    CompactRow row = {};
+    row.pathOffset = static_cast<uint32_t>(m_paths.size());
+    row.pathLength = static_cast<uint32_t>(fullPath.size());
+    row.nameOffset = static_cast<uint16_t>(fullPath.size() - filename.size());
+    row.hasRelative = dir.hasRelative ? 1 : 0;
+    row.relOffset = static_cast<uint16_t>(dir.relOffset);
+    m_paths.append(fullPath.data(), fullPath.size());
+
+    if (dirId >= m_dirCategories.size()) {
+        m_dirCategories.resize(static_cast<size_t>(dirId) + 1);
+    }
+    DirCategories& categories = m_dirCategories[dirId];
+    if (categories.generation != dir.generation) {
+        categories.generation = dir.generation;
+        categories.topCategory = intern(dir.topCategory);
+        categories.subCategory = intern(dir.subCategory);
+    }
+    row.topCategory = categories.topCategory;
+    row.subCategory = categories.subCategory;
+    row.depth = static_cast<uint16_t>(dir.depth);
+
+    // 从目录部分的自动机状态继续匹配文件名
+    m_scratch.assign(dir.relDir).append(filename.data(), filename.size());
+    AnimRuleMatcher::Hits hits = dir.hits;
+    m_classifier->matchRules(m_scratch, hits, dir.relDir.size(), dir.state);
+    store_hits(row, hits);
+    row.characterPrefix = static_cast<uint8_t>(m_classifier->findCharacterPrefix(filename) + 1);
+
+    m_rows.push_back(row);
+    return true;
+}
+
+std::string_view CompactRowTable::fullPath(size_t index) const
+{
+    const CompactRow& row = m_rows[index];
+    return std::string_view(m_paths.data() + row.pathOffset, row.pathLength);
+}
+
+std::string_view CompactRowTable::filename(size_t index) const
+{
+    return fullPath(index).substr(m_rows[index].nameOffset);
+}
+
+void CompactRowTable::appendRelativePath(size_t index, std::string& out) const
+{
+    const CompactRow& row = m_rows[index];
+    const std::string_view path = fullPath(index);
+    if (!row.hasRelative) {
+        out.append(path.data(), path.size());
+        return;
+    }
+    const size_t begin = out.size();
+    out.append(path.data() + row.relOffset, path.size() - row.relOffset);
+    StringKernels::replaceByte(&out[begin], out.size() - begin, '\\', '/');
+}
+
+const std::string& CompactRowTable::ruleName(RuleGroup group, size_t bit) const
+{
+    return m_ruleNames[static_cast<size_t>(group)][bit];
+}
+
+size_t CompactRowTable::ruleCount(RuleGroup group) const
+{
+    return m_ruleNames[static_cast<size_t>(group)].size();
+}
+
+const std::string& CompactRowTable::characterPrefixName(uint8_t id) const
+{
+    // ID 0 表示没有前缀，对应空串
+    return id == 0 ? m_categories[0] : m_prefixNames[id - 1];
+}
+
+void CompactRowTable::materialize(size_t index, CSVRow& out) const
+{
+    const CompactRow& row = m_rows[index];
+    out.index = std::to_string(index + 1);
+    out.filename.assign(filename(index));
+    out.fullpath.assign(fullPath(index));
+    out.relativePath.clear();
+    appendRelativePath(index, out.relativePath);
+    out.topCategory = m_categories[row.topCategory];
+    out.subCategory = m_categories[row.subCategory];
+
+    // 位序号即输出顺序，与 AnimRuleMatcher::format 一致
+    const auto join = [&](RuleGroup group, std::string& text) {
+        text.clear();
+        for (uint64_t bits = group_bits(row, group); bits != 0; bits &= bits - 1) {
+            if (!text.empty()) text += "; ";
+            text += ruleName(group, StringKernels::lowestBit(bits));
+        }
+    };
+    join(RuleGroup::Body, out.bodyType);
+    join(RuleGroup::Action, out.actionType);
+    join(RuleGroup::Scene, out.sceneType);
+    join(RuleGroup::Weapon, out.weaponType);
+    join(RuleGroup::Cyberware, out.cyberwareType);
+    join(RuleGroup::Tag, out.specialTags);
+    out.characterPrefix = characterPrefixName(row.characterPrefix);
+    out.depth = row.depth;
+}
+
+std::vector<size_t> CompactRowTable::countTopCategories() const
+{
+    std::vector<size_t> counts(m_categories.size(), 0);
+    for (const CompactRow& row : m_rows) {
+        ++counts[row.topCategory];
+    }
+    return counts;
+}
+
+std::vector<size_t> CompactRowTable::countRuleBits(RuleGroup group) const
+{
+    std::vector<size_t> counts(ruleCount(group), 0);
+    for (const CompactRow& row : m_rows) {
+        for (uint64_t bits = group_bits(row, group); bits != 0; bits &= bits - 1) {
+            ++counts[StringKernels::lowestBit(bits)];
+        }
+    }
+    return counts;
+}
+
+size_t CompactRowTable::memoryBytes() const
+{
+    size_t bytes = m_rows.size() * sizeof(CompactRow) + m_paths.size();
+    for (const std::string& name : m_categories) {
+        bytes += sizeof(std::string) + name.size();
+    }
+    return bytes;
+}
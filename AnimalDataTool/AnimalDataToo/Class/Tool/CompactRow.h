@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "AnimRuleMatcher.h"
+#include "DirClassCache.h"
+
+class AnimsClassifier;
+struct CSVRow;
+
+// 紧凑的分类结果行（64 字节）：分类字符串驻留为整数ID，多值列保存为 AnimRuleMatcher 的命中位图，
+// 完整路径存放在表的共享字符池中。文件名、相对路径都是完整路径的一部分，只记录起点；
+// 序号即行号 + 1。所有字符串只在输出时生成
+struct CompactRow
+{
+    uint64_t bodyBits;      // 位序号同 AnimRuleMatcher（体型/动作/场景按分类名排序）
+    uint64_t actionBits;
+    uint64_t sceneBits;
+    uint64_t tagBits;
+    uint32_t pathOffset;    // 完整路径在字符池中的位置
+    uint32_t pathLength;
+    uint32_t topCategory;   // CompactRowTable::categoryName 的ID，0 为空串
+    uint32_t subCategory;
+    uint16_t nameOffset;    // 文件名在完整路径中的起点
+    uint16_t relOffset;     // 相对路径在完整路径中的起点（"animations" 目录之后）
+    uint16_t depth;
+    uint8_t weapon;         // 第一个命中的武器分类位序号 + 1，0 表示没有
+    uint8_t cyberware;
+    uint8_t characterPrefix;  // AnimsClassifier 角色前缀的序号 + 1，0 表示没有
+    uint8_t hasRelative;    // 0 表示路径中没有 animations 目录，相对路径即完整路径
+};
+
+// 紧凑分类结果表：构造时记录分类器的规则名称，之后 add() 只做匹配、驻留和位运算，
+// 不为每行分配字符串。统计直接在ID和位图上计数
+class CompactRowTable
+{
+public:
+    // classifier 在最后一次 add() 之前必须保持有效；输出只依赖表内保存的名称
+    explicit CompactRowTable(const AnimsClassifier& classifier);
+
+    void clear();
+    void reserve(size_t rows, size_t path_bytes);
+
+    // 分类并追加一行；filename 必须是 fullPath 的后缀（与 CSVRow 的 文件名称 列相同）。
+    // 路径超过 65535 字节时报错并返回 false
+    bool add(std::string_view fullPath, std::string_view filename);
+    // 按目录缓存分类（见 DirClassCache），结果与不带 dirId 的版本相同
+    bool add(std::string_view fullPath, std::string_view filename, uint32_t dirId);
+    // 没有目录表时为目录文本分配ID
+    uint32_t internDir(std::string_view dirPart) { return m_dirCache.internDir(dirPart); }
+
+    size_t size() const { return m_rows.size(); }
+    const CompactRow& row(size_t index) const { return m_rows[index]; }
+
+    std::string_view fullPath(size_t index) const;
+    std::string_view filename(size_t index) const;
+    void appendRelativePath(size_t index, std::string& out) const;
+
+    // 驻留的 顶级分类/子分类 名称
+    const std::string& categoryName(uint32_t id) const { return m_categories[id]; }
+    size_t categoryCount() const { return m_categories.size(); }
+    const std::string& ruleName(RuleGroup group, size_t bit) const;
+    size_t ruleCount(RuleGroup group) const;
+    const std::string& characterPrefixName(uint8_t id) const;
+
+    // 还原为与 AnimsClassifier::classifyRow 相同的 CSVRow（复用 row 中字符串的容量）
+    void materialize(size_t index, CSVRow& row) const;
+
+    // 每个 顶级分类ID / 体型位 的行数
+    std::vector<size_t> countTopCategories() const;
+    std::vector<size_t> countRuleBits(RuleGroup group) const;
+
+    // 行数组、字符池和驻留表占用的内存
+    size_t memoryBytes() const;
+
+private:
+    uint32_t intern(std::string_view name);
+
+    const AnimsClassifier* m_classifier;
+    std::vector<std::string> m_ruleNames[kRuleGroupCount];
+    std::vector<std::string> m_prefixNames;
+
+    std::vector<CompactRow> m_rows;
+    std::string m_paths;  // 字符池
+    std::vector<std::string> m_categories;
+    std::unordered_map<std::string, uint32_t> m_categoryIds;
+    std::string m_scratch;  // add() 复用的相对路径缓冲区
+    DirClassCache m_dirCache;
+
+    // 目录ID -> 已驻留的 顶级/子分类 ID（generation 与缓存条目一致时有效）
+    struct DirCategories
+    {
+        uint64_t generation = 0;
+        uint32_t topCategory = 0;
+        uint32_t subCategory = 0;
+    };
+    std::vector<DirCategories> m_dirCategories;
+};
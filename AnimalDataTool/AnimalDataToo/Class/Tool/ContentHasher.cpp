@@ -0,0 +1,294 @@
+﻿#include "ContentHasher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <system_error>
+
+#include "MappedFile.h"
+#include "WorkStealingPool.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr uint64_t kPrime1 = 11400714785074694791ull;
+    constexpr uint64_t kPrime2 = 14029467366897019727ull;
+    constexpr uint64_t kPrime3 = 1609587929392839161ull;
+    constexpr uint64_t kPrime4 = 9650029242287828579ull;
+    constexpr uint64_t kPrime5 = 2870177450012600261ull;
+
+    // 每个求大小任务处理的文件数，避免每个文件一个任务
+    constexpr size_t kStatBatch = 256;
+
+    inline uint64_t rotl64(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // 按小端读取，与 XXH64 参考实现在 x86/ARM 上的结果一致
+    inline uint64_t read64(const uint8_t* p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+    {
+        acc += input * kPrime2;
+        acc = rotl64(acc, 31);
+        return acc * kPrime1;
+    }
+
+    inline uint64_t xxh_merge_round(uint64_t acc, uint64_t value)
+    {
+        acc ^= xxh_round(0, value);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    // 一个大文件的分块结果；所有块算完后按顺序合并
+    struct ChunkedFile
+    {
+        size_t index = 0;
+        MappedFile file;
+        std::vector<uint64_t> chunk_hashes;
+    };
+}
+
+ContentHasher::ContentHasher(size_t thread_count)
+    : m_threadCount(thread_count), m_chunkSize(8u << 20)
+{
+}
+
+void ContentHasher::set_chunk_size(size_t bytes)
+{
+    // 块大小至少 64 KB，过小的块只会增加调度开销
+    m_chunkSize = std::max<size_t>(bytes, 64u << 10);
+}
+
+uint64_t ContentHasher::xxh64(const void* data, size_t length, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* const end = p + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        const uint8_t* const limit = end - 32;
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge_round(h, v1);
+        h = xxh_merge_round(h, v2);
+        h = xxh_merge_round(h, v3);
+        h = xxh_merge_round(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<uint64_t>(length);
+
+    while (p + 8 <= end) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl64(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * kPrime5;
+        h = rotl64(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::string ContentHasher::to_hex(uint64_t value)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        text[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    return text;
+}
+
+std::string ContentHasher::hash_hex(size_t index) const
+{
+    return has_hash(index) ? to_hex(m_hashes[index]) : std::string();
+}
+
+std::string ContentHasher::duplicates_path_for_csv(const std::string& csv_output_path)
+{
+    fs::path path(csv_output_path);
+    fs::path report = path;
+    report.replace_filename(path.stem().string() + "_duplicates.csv");
+    return report.string();
+}
+
+uint64_t ContentHasher::duplicate_bytes() const
+{
+    uint64_t bytes = 0;
+    for (const std::vector<size_t>& group : m_groups) {
+        bytes += m_sizes[group.front()] * (group.size() - 1);
+    }
+    return bytes;
+}
+
+bool ContentHasher::hash_files(const std::vector<std::string>& files)
+{
+    const size_t count = files.size();
+    m_sizes.assign(count, kUnknownSize);
+    m_hashes.assign(count, 0);
+    m_hashed.assign(count, 0);
+    m_groups.clear();
+    m_hashedCount = 0;
+    m_hashedBytes = 0;
+    if (count == 0) return true;
+
+    WorkStealingPool pool(m_threadCount);
+
+    // 1. 求文件大小（每个元素只由一个任务写入，无需加锁）
+    for (size_t begin = 0; begin < count; begin += kStatBatch) {
+        const size_t end = std::min(count, begin + kStatBatch);
+        pool.submit([this, &files, begin, end] {
+            for (size_t i = begin; i < end; ++i) {
+                std::error_code ec;
+                uint64_t size = fs::file_size(files[i], ec);
+                if (!ec) m_sizes[i] = size;
+            }
+        });
+    }
+    pool.wait();
+
+    bool all_ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (m_sizes[i] == kUnknownSize) {
+            std::cerr << "错误：无法读取文件大小 -> " << files[i] << std::endl;
+            all_ok = false;
+        }
+    }
+
+    // 2. 按大小分组，大小唯一的文件不可能有重复，跳过哈希
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return m_sizes[a] < m_sizes[b]; });
+
+    std::vector<size_t> candidates;
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin + 1;
+        while (end < count && m_sizes[order[end]] == m_sizes[order[begin]]) ++end;
+        if (m_sizes[order[begin]] != kUnknownSize && (end - begin > 1 || m_hashUniqueSizes)) {
+            candidates.insert(candidates.end(), order.begin() + begin, order.begin() + end);
+        }
+        begin = end;
+    }
+
+    // 3. 映射并计算哈希：小文件一个任务，大文件每块一个任务
+    std::vector<std::unique_ptr<ChunkedFile>> chunked;
+    for (size_t index : candidates) {
+        if (m_sizes[index] <= m_chunkSize) {
+            pool.submit([this, &files, index] {
+                MappedFile file;
+                if (!file.open(files[index])) return;
+                m_sizes[index] = file.size();
+                m_hashes[index] = xxh64(file.data(), file.size());
+                m_hashed[index] = 1;
+            });
+            continue;
+        }
+
+        // 大文件在提交线程映射一次，各块任务共享同一映射
+        std::unique_ptr<ChunkedFile> entry(new ChunkedFile);
+        entry->index = index;
+        if (!entry->file.open(files[index])) continue;
+        const size_t size = entry->file.size();
+        const size_t chunks = (size + m_chunkSize - 1) / m_chunkSize;
+        entry->chunk_hashes.assign(chunks, 0);
+        ChunkedFile* target = entry.get();
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            pool.submit([this, target, chunk, size] {
+                const size_t offset = chunk * m_chunkSize;
+                const size_t length = std::min(m_chunkSize, size - offset);
+                target->chunk_hashes[chunk] = xxh64(target->file.data() + offset, length);
+            });
+        }
+        chunked.push_back(std::move(entry));
+    }
+    pool.wait();
+
+    // 块哈希按顺序再做一次 XXH64，以文件大小为种子；结果只取决于内容和块大小
+    for (const std::unique_ptr<ChunkedFile>& entry : chunked) {
+        const size_t index = entry->index;
+        m_sizes[index] = entry->file.size();
+        m_hashes[index] = xxh64(entry->chunk_hashes.data(), entry->chunk_hashes.size() * sizeof(uint64_t),
+                                m_sizes[index]);
+        m_hashed[index] = 1;
+    }
+
+    for (size_t index : candidates) {
+        if (m_hashed[index]) {
+            ++m_hashedCount;
+            m_hashedBytes += m_sizes[index];
+        } else {
+            all_ok = false;
+        }
+    }
+
+    // 4. 大小和哈希都相同的文件归为一组
+    std::vector<size_t> hashed;
+    for (size_t index : candidates) {
+        if (m_hashed[index]) hashed.push_back(index);
+    }
+    std::sort(hashed.begin(), hashed.end(), [this](size_t a, size_t b) {
+        if (m_sizes[a] != m_sizes[b]) return m_sizes[a] < m_sizes[b];
+        if (m_hashes[a] != m_hashes[b]) return m_hashes[a] < m_hashes[b];
+        return a < b;
+    });
+    for (size_t begin = 0; begin < hashed.size();) {
+        size_t end = begin + 1;
+        while (end < hashed.size() && m_sizes[hashed[end]] == m_sizes[hashed[begin]] &&
+               m_hashes[hashed[end]] == m_hashes[hashed[begin]]) {
+            ++end;
+        }
+        if (end - begin > 1) {
+            m_groups.emplace_back(hashed.begin() + begin, hashed.begin() + end);
+        }
+        begin = end;
+    }
+    std::sort(m_groups.begin(), m_groups.end(),
+              [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.front() < b.front(); });
+
+    return all_ok;
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 内容哈希与重复动画检测：先按文件大小分组，只有大小相同的文件才需要计算哈希；
+// 文件内存映射后在工作窃取线程池上计算 XXH64，大文件按块并行计算后再合并块哈希
+class ContentHasher
+{
+public:
+    static constexpr uint64_t kUnknownSize = ~0ull;
+
+    // thread_count 为 0 时使用 std::thread::hardware_concurrency()
+    explicit ContentHasher(size_t thread_count = 0);
+
+    // 超过该大小的文件按块并行计算，默认 8 MB
+    void set_chunk_size(size_t bytes);
+    // 为 true 时大小唯一的文件也计算哈希（CSV 中每行都有 content_hash）
+    void set_hash_unique_sizes(bool enabled) { m_hashUniqueSizes = enabled; }
+
+    // 计算 files 中各文件的大小和内容哈希并找出重复分组；有文件无法读取时返回 false（其余结果仍有效）
+    bool hash_files(const std::vector<std::string>& files);
+
+    size_t file_count() const { return m_sizes.size(); }
+    uint64_t file_size(size_t index) const { return m_sizes[index]; }
+    bool has_hash(size_t index) const { return m_hashed[index] != 0; }
+    uint64_t hash(size_t index) const { return m_hashes[index]; }
+    // 16 位十六进制哈希，未计算哈希的文件返回空串
+    std::string hash_hex(size_t index) const;
+
+    // 内容相同的文件分组（文件下标升序，分组按首个下标排序），每组至少两个文件
+    const std::vector<std::vector<size_t>>& duplicate_groups() const { return m_groups; }
+
+    size_t hashed_count() const { return m_hashedCount; }
+    uint64_t hashed_bytes() const { return m_hashedBytes; }
+    // 重复文件（每组除第一个之外）占用的字节数
+    uint64_t duplicate_bytes() const;
+
+    // 重复分组报告的默认路径：xxx.csv -> xxx_duplicates.csv
+    static std::string duplicates_path_for_csv(const std::string& csv_output_path);
+
+    static uint64_t xxh64(const void* data, size_t length, uint64_t seed = 0);
+    static std::string to_hex(uint64_t value);
+
+private:
+    size_t m_threadCount;
+    size_t m_chunkSize;
+    bool m_hashUniqueSizes = false;
+
+    std::vector<uint64_t> m_sizes;
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint8_t> m_hashed;
+    std::vector<std::vector<size_t>> m_groups;
+    size_t m_hashedCount = 0;
+    uint64_t m_hashedBytes = 0;
+};
@@ -0,0 +1,197 @@
+﻿#include "CsvReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "StringKernels.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    constexpr size_t kBlockBytes = 64;
+
+    // 第 i 位为 bits 第 0..i 位的异或：引号位图变成"该字节之后是否在引号内"
+    inline uint64_t prefix_xor(uint64_t bits)
+    {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+}
+
+CsvReader::Cursor::Cursor(std::string_view text, size_t begin, size_t limit, bool in_quotes)
+    : m_text(text)
+    , m_pos(begin)
+    , m_limit(std::min(limit, text.size()))
+    , m_scan(begin)
+    , m_inQuotes(in_quotes ? ~uint64_t(0) : 0)
+{
+}
+
+void CsvReader::Cursor::load_block()
+{
+    // masks: 引号、逗号、换行
+    uint64_t masks[3];
+    StringKernels::byteMasks64(m_text.data() + m_scan, m_text.size() - m_scan, "\",\n", masks);
+    const uint64_t inside = prefix_xor(masks[0]) ^ m_inQuotes;
+    m_separators = (masks[1] | masks[2]) & ~inside;
+    m_inQuotes = uint64_t(0) - (inside >> 63);
+    m_blockBase = m_scan;
+    m_scan += kBlockBytes;
+}
+
+size_t CsvReader::Cursor::next_separator()
+{
+    while (m_separators == 0) {
+        if (m_scan >= m_text.size()) return m_text.size();
+        load_block();
+    }
+    const size_t pos = m_blockBase + StringKernels::lowestBit(m_separators);
+    m_separators &= m_separators - 1;
+    return pos;
+}
+
+bool CsvReader::Cursor::next(CsvRow& row)
+{
+    if (m_pos >= m_limit) return false;
+
+    const char* data = m_text.data();
+    const size_t size = m_text.size();
+    row.m_fields.clear();
+    size_t start = m_pos;
+    for (;;) {
+        const size_t separator = next_separator();
+        if (separator < size && data[separator] == ',') {
+            row.m_fields.emplace_back(data + start, separator - start);
+            start = separator + 1;
+            continue;
+        }
+
+        // 记录结束：引号外的换行或文本末尾
+        size_t end = separator;
+        if (end > start && data[end - 1] == '\r') --end;
+        row.m_fields.emplace_back(data + start, end - start);
+        row.m_text = std::string_view(data + m_pos, end - m_pos);
+        m_pos = separator < size ? separator + 1 : size;
+        break;
+    }
+
+    // 大多数记录没有引号，字段直接指向原文
+    if (std::memchr(row.m_text.data(), '"', row.m_text.size())) decode_fields(row);
+    return true;
+}
+
+void CsvReader::Cursor::decode_fields(CsvRow& row) const
+{
+    // 解码后的总长度不超过记录长度，预留后追加不会使前面字段的视图失效
+    row.m_decoded.clear();
+    row.m_decoded.reserve(row.m_text.size());
+    for (std::string_view& field : row.m_fields) {
+        if (field.find('"') == std::string_view::npos) continue;
+        // 整个字段加引号且内部没有转义引号：去掉首尾引号即可
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"' &&
+            field.substr(1, field.size() - 2).find('"') == std::string_view::npos) {
+            field = field.substr(1, field.size() - 2);
+            continue;
+        }
+
+        // 其余情况与 parseCSVLine 相同：引号切换引号内状态，引号内的 "" 表示一个引号
+        const size_t begin = row.m_decoded.size();
+        bool in_quotes = false;
+        for (size_t i = 0; i < field.size(); ++i) {
+            const char c = field[i];
+            if (c != '"') {
+                row.m_decoded.push_back(c);
+            } else if (in_quotes && i + 1 < field.size() && field[i + 1] == '"') {
+                row.m_decoded.push_back('"');
+                ++i;
+            } else {
+                in_quotes = !in_quotes;
+            }
+        }
+        field = std::string_view(row.m_decoded.data() + begin, row.m_decoded.size() - begin);
+    }
+}
+
+CsvReader::CsvReader()
+{
+}
+
+bool CsvReader::open(const std::string& path)
+{
+    close();
+    if (!m_file.open(path)) return false;
+    assign(std::string_view(reinterpret_cast<const char*>(m_file.data()), m_file.size()));
+    return true;
+}
+
+void CsvReader::close()
+{
+    m_file.close();
+    m_text = std::string_view();
+}
+
+void CsvReader::assign(std::string_view text)
+{
+    if (text.size() >= 3 && std::memcmp(text.data(), "\xEF\xBB\xBF", 3) == 0) text.remove_prefix(3);
+    m_text = text;
+}
+
+CsvReader::Cursor CsvReader::rows(size_t offset) const
+{
+    return Cursor(m_text, offset, m_text.size(), false);
+}
+
+CsvReader::Cursor CsvReader::rows(const Chunk& chunk) const
+{
+    return Cursor(m_text, chunk.begin, chunk.end, false);
+}
+
+size_t CsvReader::record_start_at(size_t pos, bool in_quotes) const
+{
+    // 前一个字节是引号外的换行时 pos 本身就是记录开头（换行不是引号，不影响引号状态）
+    if (!in_quotes && m_text[pos - 1] == '\n') return pos;
+    Cursor cursor(m_text, pos, m_text.size(), in_quotes);
+    for (;;) {
+        const size_t separator = cursor.next_separator();
+        if (separator >= m_text.size()) return m_text.size();
+        if (m_text[separator] == '\n') return separator + 1;
+    }
+}
+
+std::vector<CsvReader::Chunk> CsvReader::split(size_t offset, size_t chunk_count, WorkStealingPool& pool) const
+{
+    const size_t size = m_text.size();
+    if (offset >= size) return {};
+    const size_t bytes = size - offset;
+    chunk_count = std::max<size_t>(1, std::min(chunk_count, bytes / kMinChunkBytes));
+    if (chunk_count == 1) return { Chunk{ offset, size } };
+
+    // 第一遍：每块的引号数（前面各块引号数之和的奇偶性即该块起点是否在引号内）
+    std::vector<size_t> bounds(chunk_count + 1);
+    for (size_t k = 0; k <= chunk_count; ++k) bounds[k] = offset + bytes / chunk_count * k;
+    bounds[chunk_count] = size;
+    std::vector<size_t> quotes(chunk_count);
+    for (size_t k = 0; k < chunk_count; ++k) {
+        pool.submit([this, &bounds, &quotes, k] {
+            quotes[k] = StringKernels::countByte(m_text.substr(bounds[k], bounds[k + 1] - bounds[k]), '"');
+        });
+    }
+    pool.wait();
+
+    // 第二遍：从每块起点找到第一个记录开头；一条很长的记录可能跨过整块，此时该块为空
+    std::vector<Chunk> chunks(chunk_count);
+    size_t parity = 0;
+    size_t begin = offset;
+    for (size_t k = 0; k < chunk_count; ++k) {
+        parity += quotes[k];
+        const size_t end = k + 1 < chunk_count ? std::max(begin, record_start_at(bounds[k + 1], parity % 2 != 0)) : size;
+        chunks[k] = Chunk{ begin, end };
+        begin = end;
+    }
+    return chunks;
+}
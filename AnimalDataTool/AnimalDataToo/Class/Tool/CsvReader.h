@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+class WorkStealingPool;
+
+// CSV 的一条记录：字段是指向文件映射（或 assign 的文本）的 string_view，不复制；
+// 只有含转义引号等需要解码的字段才写入本行自己的缓冲区。字段在读取下一条记录之前有效
+class CsvRow
+{
+public:
+    size_t size() const { return m_fields.size(); }
+    std::string_view operator[](size_t i) const { return m_fields[i]; }
+    // 越界时返回空串
+    std::string_view field(size_t i) const { return i < m_fields.size() ? m_fields[i] : std::string_view(); }
+    // 记录的原始文本（不含行尾的 "\n" / "\r\n"）
+    std::string_view text() const { return m_text; }
+
+private:
+    friend class CsvReader;
+
+    std::vector<std::string_view> m_fields;
+    std::string m_decoded;
+    std::string_view m_text;
+};
+
+// 只读 CSV：内存映射整个文件，每 64 个字节用向量比较得到引号、逗号、换行的位图，
+// 引号位图的前缀异或就是每个字节是否在引号内，去掉引号内的逗号和换行即字段和记录的边界（simdcsv 的做法）。
+// 字段的解析规则与 parseCSVLine 相同；记录以引号外的 '\n' 结束，行尾的 '\r' 不属于字段，引号内的换行原样保留
+class CsvReader
+{
+public:
+    // 大文件分块读取时每块至少 1 MB
+    static constexpr size_t kMinChunkBytes = size_t(1) << 20;
+
+    // 在 [begin, end) 中开始的记录（end 之后的部分照常读完）
+    struct Chunk
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    // 顺序读取记录的游标
+    class Cursor
+    {
+    public:
+        // 读取下一条记录，没有更多记录时返回 false
+        bool next(CsvRow& row);
+        // 下一条记录的开头（可以传给 split 跳过表头）
+        size_t offset() const { return m_pos; }
+
+    private:
+        friend class CsvReader;
+        Cursor(std::string_view text, size_t begin, size_t limit, bool in_quotes);
+
+        // 下一个引号外的逗号或换行的位置，没有时返回 m_text.size()
+        size_t next_separator();
+        void load_block();
+        void decode_fields(CsvRow& row) const;
+
+        std::string_view m_text;
+        size_t m_pos;
+        size_t m_limit;
+        size_t m_scan;               // 下一个待分析的块的起点
+        size_t m_blockBase = 0;
+        uint64_t m_separators = 0;   // 当前块中尚未读到的分隔符
+        uint64_t m_inQuotes;         // m_scan 处在引号内时为全 1
+    };
+
+    CsvReader();
+
+    // 映射文件，失败时输出错误并返回 false；开头的 UTF-8 BOM 不属于第一条记录
+    bool open(const std::string& path);
+    void close();
+    // 读取内存中的文本（不复制，由调用方保证生命周期）
+    void assign(std::string_view text);
+    std::string_view text() const { return m_text; }
+
+    // 从 offset（必须是记录开头：0 或 Cursor::offset()）开始顺序读取
+    Cursor rows(size_t offset = 0) const;
+    Cursor rows(const Chunk& chunk) const;
+
+    // 把 offset 之后的记录分成约 chunk_count 块（每块至少 kMinChunkBytes），按文件顺序排列，块边界都是记录开头。
+    // 先在线程池上统计每块的引号数，得到每块起点是否在引号内，再从起点找到第一个引号外的换行，
+    // 因此引号内的换行不会被当成边界。各块可以交给不同线程用 rows(chunk) 读取
+    std::vector<Chunk> split(size_t offset, size_t chunk_count, WorkStealingPool& pool) const;
+
+private:
+    // pos 处（引号状态为 in_quotes）之后的第一个记录开头，没有时返回文本长度
+    size_t record_start_at(size_t pos, bool in_quotes) const;
+
+    MappedFile m_file;
+    std::string_view m_text;
+};
@@ -0,0 +1,312 @@
+﻿#include "CsvWriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include "AnimGroup.h"
+#include "WorkStealingPool.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+CsvWriter::CsvWriter(size_t buffer_size, size_t buffer_count)
+    : m_bufferSize(std::max<size_t>(buffer_size, 4096))
+    , m_bufferCount(std::max<size_t>(buffer_count, 2))  // 至少两块：一块格式化，一块写盘
+{
+    m_buffer.reserve(m_bufferSize);
+    m_free.resize(m_bufferCount - 1);
+    for (std::string& buffer : m_free) buffer.reserve(m_bufferSize);
+    m_pending.reserve(m_bufferCount);
+}
+
+CsvWriter::~CsvWriter()
+{
+    close();
+}
+
+bool CsvWriter::open(const std::string& path)
+{
+    close();
+
+#if defined(_WIN32)
+    // 经 fs::path 转成宽字符路径，支持非 ASCII 文件名
+    const std::wstring wide = std::filesystem::path(path).wstring();
+    HANDLE file = CreateFileW(wide.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    m_file = file;
+#else
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (m_fd < 0) return false;
+#endif
+
+    m_path = path;
+    m_buffer.clear();
+    m_closing = false;
+    m_failed = false;
+    m_open = true;
+    m_flusher = std::thread(&CsvWriter::flush_loop, this);
+    return true;
+}
+
+bool CsvWriter::close()
+{
+    if (!m_open) return true;
+
+    // 最后一块不需要再换空闲缓冲区，写盘线程结束后再取回
+    const bool handed_over = !m_buffer.empty();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (handed_over) m_pending.push_back(std::move(m_buffer));
+        m_closing = true;
+    }
+    m_cv.notify_all();
+    m_flusher.join();
+
+    if (handed_over) {
+        m_buffer = std::move(m_free.back());
+        m_free.pop_back();
+        m_buffer.clear();
+    }
+    close_file();
+    m_open = false;
+
+    if (m_failed) {
+        std::cerr << "错误：写入 CSV 文件失败 -> " << m_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CsvWriter::append_uint(uint64_t value)
+{
+    append_uint(m_buffer, value);
+    commit();
+}
+
+void CsvWriter::append_field(std::string_view field)
+{
+    appendEscapedCSV(m_buffer, field);
+    commit();
+}
+
+void CsvWriter::append_quoted(std::string_view text)
+{
+    append_quoted(m_buffer, text);
+    commit();
+}
+
+void CsvWriter::append_uint(std::string& out, uint64_t value)
+{
+    char digits[20];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void CsvWriter::append_quoted(std::string& out, std::string_view text)
+{
+    out.push_back('"');
+    out.append(text.data(), text.size());
+    out.push_back('"');
+}
+
+void CsvWriter::append_rows(size_t count, const RangeFormatter& format, size_t thread_count)
+{
+    const size_t chunks = (count + kChunkRows - 1) / kChunkRows;
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    if (thread_count < 2 || chunks < 2) {
+        for (size_t begin = 0; begin < count; begin += kChunkRows) {
+            format(begin, std::min(count, begin + kChunkRows), m_buffer);
+            commit();
+        }
+        return;
+    }
+
+    WorkStealingPool pool(std::min(thread_count, chunks));
+    // 每批每个线程两块，减少等待最慢一块时的空闲；再多一批缓冲区，使上一批写盘时下一批可以格式化
+    const size_t wave = std::min(chunks, pool.thread_count() * 2);
+    reserve_buffers(2 * wave + 1);
+
+    // 之前追加的内容先排队，保证顺序
+    if (!m_buffer.empty()) submit();
+
+    std::vector<std::string> buffers(wave);
+    for (size_t first = 0; first < chunks; first += wave) {
+        const size_t n = std::min(wave, chunks - first);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this, n] { return m_free.size() >= n; });
+            for (size_t k = 0; k < n; ++k) {
+                buffers[k] = std::move(m_free.back());
+                m_free.pop_back();
+                buffers[k].clear();
+            }
+        }
+
+        for (size_t k = 0; k < n; ++k) {
+            const size_t begin = (first + k) * kChunkRows;
+            const size_t end = std::min(count, begin + kChunkRows);
+            std::string* out = &buffers[k];
+            pool.submit([&format, begin, end, out] { format(begin, end, *out); });
+        }
+        pool.wait();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t k = 0; k < n; ++k) m_pending.push_back(std::move(buffers[k]));
+        }
+        m_cv.notify_all();
+    }
+}
+
+void CsvWriter::submit()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.push_back(std::move(m_buffer));
+    m_cv.notify_all();
+    m_cv.wait(lock, [this] { return !m_free.empty(); });
+    m_buffer = std::move(m_free.back());
+    m_free.pop_back();
+    m_buffer.clear();
+}
+
+void CsvWriter::reserve_buffers(size_t count)
+{
+    if (count <= m_bufferCount) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (; m_bufferCount < count; ++m_bufferCount) m_free.emplace_back();
+    m_pending.reserve(m_bufferCount);
+}
+
+void CsvWriter::flush_loop()
+{
+    std::vector<std::string> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return !m_pending.empty() || m_closing; });
+            if (m_pending.empty()) return;
+            batch.swap(m_pending);
+        }
+
+        // 失败后不再写盘，但照常归还缓冲区，避免格式化线程等待
+        const bool ok = m_failed || write_batch(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!ok) m_failed = true;
+            for (std::string& buffer : batch) {
+                buffer.clear();
+                m_free.push_back(std::move(buffer));
+            }
+        }
+        batch.clear();
+        m_cv.notify_all();
+    }
+}
+
+#if defined(_WIN32)
+bool CsvWriter::write_batch(std::vector<std::string>& batch)
+{
+    // WriteFileGather 要求无缓冲、按扇区对齐的 I/O，这里逐块 WriteFile；
+    // 文本模式的 ofstream 会把每个 '\n' 写成 "\r\n"，写盘前做同样的转换
+    for (const std::string& buffer : batch) {
+        m_translated.clear();
+        m_translated.reserve(buffer.size() + buffer.size() / 16);
+        const char* data = buffer.data();
+        const char* end = data + buffer.size();
+        while (data < end) {
+            const char* newline = static_cast<const char*>(std::memchr(data, '\n', static_cast<size_t>(end - data)));
+            if (!newline) {
+                m_translated.append(data, end);
+                break;
+            }
+            m_translated.append(data, newline);
+            m_translated.append("\r\n", 2);
+            data = newline + 1;
+        }
+
+        const char* out = m_translated.data();
+        size_t remaining = m_translated.size();
+        while (remaining > 0) {
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(remaining, 0x40000000));
+            DWORD written = 0;
+            if (!WriteFile(static_cast<HANDLE>(m_file), out, chunk, &written, nullptr) || written == 0) return false;
+            out += written;
+            remaining -= written;
+        }
+    }
+    return true;
+}
+
+void CsvWriter::close_file()
+{
+    if (m_file) {
+        CloseHandle(static_cast<HANDLE>(m_file));
+        m_file = nullptr;
+    }
+}
+#else
+bool CsvWriter::write_batch(std::vector<std::string>& batch)
+{
+#if defined(IOV_MAX)
+    constexpr size_t kMaxIov = IOV_MAX < 64 ? IOV_MAX : 64;
+#else
+    constexpr size_t kMaxIov = 16;
+#endif
+    iovec iov[kMaxIov];
+    size_t next = 0;
+    while (next < batch.size()) {
+        size_t count = 0;
+        for (; count < kMaxIov && next + count < batch.size(); ++count) {
+            iov[count].iov_base = &batch[next + count][0];
+            iov[count].iov_len = batch[next + count].size();
+        }
+        next += count;
+
+        // 部分写入时跳过已写完的块，从剩余位置继续
+        iovec* pos = iov;
+        while (count > 0) {
+            const ssize_t written = ::writev(m_fd, pos, static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            size_t left = static_cast<size_t>(written);
+            while (count > 0 && left >= pos->iov_len) {
+                left -= pos->iov_len;
+                ++pos;
+                --count;
+            }
+            if (count > 0) {
+                pos->iov_base = static_cast<char*>(pos->iov_base) + left;
+                pos->iov_len -= left;
+            }
+        }
+    }
+    return true;
+}
+
+void CsvWriter::close_file()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+#endif
@@ -0,0 +1,94 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 大缓冲区的 CSV 文件写出：行直接格式化到当前缓冲区，攒够 buffer_size 字节后交给后台写盘线程，
+// 格式化线程换一块空闲缓冲区继续写（几块缓冲区轮换，写盘跟不上时格式化线程等待空闲缓冲区）。
+// 写盘线程每次取走所有待写的缓冲区：POSIX 上用 writev 一次提交，Windows 上逐块 WriteFile。
+// 输出与文本模式的 std::ofstream 逐字节相同：Windows 上每个 '\n'（包括引号内的换行）写成 "\r\n"
+class CsvWriter
+{
+public:
+    static constexpr size_t kDefaultBufferSize = size_t(1) << 20;
+    static constexpr size_t kDefaultBufferCount = 4;
+    // append_rows 每块的行数
+    static constexpr size_t kChunkRows = 4096;
+
+    // 把 [begin, end) 行（含换行）追加到 out 末尾
+    using RangeFormatter = std::function<void(size_t begin, size_t end, std::string& out)>;
+
+    explicit CsvWriter(size_t buffer_size = kDefaultBufferSize, size_t buffer_count = kDefaultBufferCount);
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    // 创建或截断文件并启动写盘线程
+    bool open(const std::string& path);
+    // 写出剩余数据、等待写盘线程结束并关闭文件；打开后任何一次写入失败都返回 false 并输出错误
+    bool close();
+    bool is_open() const { return m_open; }
+
+    void append(std::string_view text) { m_buffer.append(text.data(), text.size()); commit(); }
+    void append(char c) { m_buffer.push_back(c); commit(); }
+    void append_uint(uint64_t value);
+    // 按 escapeCSV 的规则写出一个字段
+    void append_field(std::string_view field);
+    // 原样加上双引号（不转义内部的引号，与 序号,文件名称,完整路径 格式的文件名和路径列一致）
+    void append_quoted(std::string_view text);
+    void end_row() { append('\n'); }
+
+    // 把 count 行按 kChunkRows 分块，在线程池上各自格式化到独立的缓冲区，再按块的顺序交给写盘线程，
+    // 输出与在当前线程逐块格式化完全相同。format 会被多个线程同时调用，只能读取共享数据；
+    // thread_count 为 0 时使用硬件线程数，只有一个线程或不足两块时直接在当前线程格式化
+    void append_rows(size_t count, const RangeFormatter& format, size_t thread_count = 0);
+
+    // 格式化到任意字符串（供 RangeFormatter 使用），规则与同名的 append_* 相同
+    static void append_uint(std::string& out, uint64_t value);
+    static void append_quoted(std::string& out, std::string_view text);
+
+    // 直接格式化到当前缓冲区（例如 appendClassifiedFields），写完一行后调用 commit()
+    std::string& buffer() { return m_buffer; }
+    void commit()
+    {
+        if (m_buffer.size() >= m_bufferSize) submit();
+    }
+
+private:
+    // 当前缓冲区交给写盘线程，换一块空闲缓冲区
+    void submit();
+    // 空闲和排队的缓冲区合计不少于 count 块
+    void reserve_buffers(size_t count);
+    void flush_loop();
+    // 写盘线程中写出一批缓冲区，失败时返回 false
+    bool write_batch(std::vector<std::string>& batch);
+    void close_file();
+
+    size_t m_bufferSize;
+    std::string m_buffer;
+    std::string m_path;
+    bool m_open = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::string> m_pending;  // 按写入顺序排队的缓冲区
+    std::vector<std::string> m_free;
+    size_t m_bufferCount;  // 包括当前缓冲区
+    bool m_closing = false;
+    bool m_failed = false;
+    std::thread m_flusher;
+
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    std::string m_translated;  // 换行转换后的数据，只由写盘线程使用
+#else
+    int m_fd = -1;
+#endif
+};
@@ -0,0 +1,61 @@
+﻿#include "DirClassCache.h"
+#include "AnimGroup.h"
+
+DirClassCache::DirClassCache()
+{
+}
+
+void DirClassCache::clear()
+{
+    m_entries.clear();
+    m_dirIds.clear();
+    m_lastDir.clear();
+    m_lastDirId = 0;
+    m_rules.reset();
+    m_hits = 0;
+    m_misses = 0;
+}
+
+uint32_t DirClassCache::internDir(std::string_view dirPart)
+{
+    if (!m_dirIds.empty() && m_lastDir == dirPart) {
+        return m_lastDirId;
+    }
+    m_lastDir.assign(dirPart.data(), dirPart.size());
+    m_lastDirId = m_dirIds.emplace(m_lastDir, static_cast<uint32_t>(m_dirIds.size())).first->second;
+    return m_lastDirId;
+}
+
+const DirClassCache::Entry& DirClassCache::lookup(const AnimsClassifier& classifier, uint32_t dirId,
+                                                  std::string_view dirPart)
+{
+    // 规则更换后自动机状态和位序号都不再有效
+    if (classifier.activeRules() != m_rules) {
+        m_entries.clear();
+        m_rules = classifier.activeRules();
+    }
+    if (dirId >= m_entries.size()) {
+        m_entries.resize(static_cast<size_t>(dirId) + 1);
+    }
+
+    Entry& entry = m_entries[dirId];
+    if (entry.generation != 0 && entry.dirPart == dirPart) {
+        ++m_hits;
+        return entry;
+    }
+
+    ++m_misses;
+    entry.dirPart.assign(dirPart.data(), dirPart.size());
+    // 与 extractRelativePath 相同的查找顺序；文件名中没有分隔符时，两种标记只可能出现在目录部分
+    const size_t offset = AnimsClassifier::relativePathOffset(entry.dirPart);
+    entry.hasRelative = offset != std::string_view::npos;
+    entry.relOffset = entry.hasRelative ? static_cast<uint32_t>(offset) : 0;
+    entry.relDir = classifier.extractRelativePath(entry.dirPart);
+    entry.topCategory = classifier.getTopCategory(entry.relDir);
+    entry.subCategory = classifier.getSubCategory(entry.relDir);
+    entry.depth = classifier.getDepth(entry.relDir);
+    entry.hits = AnimRuleMatcher::Hits();
+    entry.state = classifier.matchRules(entry.relDir, entry.hits);
+    entry.generation = ++m_generation;
+    return entry;
+}
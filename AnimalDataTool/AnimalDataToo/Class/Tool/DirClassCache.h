@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "AnimRuleMatcher.h"
+
+class AnimsClassifier;
+
+// 目录级分类缓存：以目录ID为键，保存目录部分的相对路径、顶级/子分类、深度，
+// 以及规则自动机读完目录部分后的状态和命中位图。同一目录下的文件只需从该状态继续匹配文件名，
+// 跨越目录/文件名边界的关键字和 \b 判断都与整条路径匹配一致。
+// 缓存不是线程安全的，每个分类线程使用自己的实例
+class DirClassCache
+{
+public:
+    struct Entry
+    {
+        std::string dirPart;      // 完整路径中的目录部分（含结尾分隔符），用于校验目录ID
+        std::string relDir;       // 相对路径中的目录部分（与 extractRelativePath 的结果一致）
+        std::string topCategory;
+        std::string subCategory;
+        AnimRuleMatcher::Hits hits;
+        size_t state = 0;         // 自动机读完 relDir 后的状态
+        uint32_t relOffset = 0;   // 相对路径在完整路径中的起点
+        bool hasRelative = false; // 路径中有 animations 目录
+        int depth = 0;
+        uint64_t generation = 0;  // 每次重新计算都不同，0 表示无效；调用方可据此缓存自己的派生数据
+    };
+
+    DirClassCache();
+
+    void clear();
+
+    // 没有目录表的调用方按目录文本分配ID（同一目录文本总是得到同一ID）；
+    // 遍历结果中同一目录的文件通常相邻，与上一次的目录相同时不查哈希表
+    uint32_t internDir(std::string_view dirPart);
+
+    // dirPart 为完整路径去掉文件名后的部分。ID 对应的目录文本不同或规则已更换时重新计算
+    const Entry& lookup(const AnimsClassifier& classifier, uint32_t dirId, std::string_view dirPart);
+
+    size_t hitCount() const { return m_hits; }
+    size_t missCount() const { return m_misses; }
+
+private:
+    std::vector<Entry> m_entries;  // 下标为目录ID
+    std::unordered_map<std::string, uint32_t> m_dirIds;
+    std::string m_lastDir;
+    uint32_t m_lastDirId = 0;
+    std::shared_ptr<const AnimRuleMatcher> m_rules;  // 计算缓存时生效的规则（持有引用，避免地址被新规则复用）
+    uint64_t m_generation = 0;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
@@ -1,6 +1,80 @@
 ﻿#include "FindAnim.h"
 
+#include <chrono>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <memory>
+
+#include "PathTable.h"
+#include "ScanManifest.h"
+#include "ScanStats.h"
+#include "WorkStealingPool.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // 直接比较原生路径字符串的末尾，避免为每个目录项构造 filename 字符串
+    bool has_anims_suffix(const fs::path& path)
+    {
+        static const fs::path::value_type suffix[] = {'.', 'a', 'n', 'i', 'm', 's'};
+        const size_t suffix_len = sizeof(suffix) / sizeof(suffix[0]);
+        const fs::path::string_type& native = path.native();
+        if (native.size() < suffix_len) return false;
+        return native.compare(native.size() - suffix_len, suffix_len, suffix, suffix_len) == 0;
+    }
+
+    // 并行遍历时的目录树节点，order 记录 files/children 在原目录中的交错顺序
+    struct DirNode
+    {
+        std::vector<std::string> files;
+        std::vector<std::unique_ptr<DirNode>> children;
+        std::vector<bool> order;  // true = 下一个子目录，false = 下一个文件
+    };
+
+    // 清单中的名称统一保存为 UTF-8，避免 Windows 下 string() 走本地代码页丢字符
+    std::string path_to_utf8(const fs::path& path)
+    {
+        auto utf8 = path.u8string();
+        return std::string(utf8.begin(), utf8.end());
+    }
+
+    fs::path path_from_utf8(const std::string& utf8)
+    {
+#if defined(__cpp_char8_t)
+        return fs::path(std::u8string(utf8.begin(), utf8.end()));
+#else
+        return fs::u8path(utf8);
+#endif
+    }
+
+    int64_t file_time_to_int(fs::file_time_type time)
+    {
+        return static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    // 按 recursive_directory_iterator 的先序顺序展开目录树
+    void flatten_dir_node(const DirNode& node, std::vector<std::string>& out)
+    {
+        size_t file_index = 0;
+        size_t child_index = 0;
+        for (bool is_dir : node.order) {
+            if (is_dir) {
+                flatten_dir_node(*node.children[child_index++], out);
+            } else {
+                out.push_back(node.files[file_index++]);
+            }
+        }
+    }
+}
 
 
 FindAnim::FindAnim()
@@ -8,6 +82,51 @@ FindAnim::FindAnim()
     
 }
 
+void FindAnim::set_backend(ScanBackend backend)
+{
+    m_backend = backend;
+}
+
+bool FindAnim::uses_raw_backend() const
+{
+#if defined(__linux__)
+    return m_backend != ScanBackend::StdFilesystem;
+#else
+    return false;
+#endif
+}
+
+bool FindAnim::match_file_name(const char* name, size_t length) const
+{
+    if (m_filter) return m_filter->match_extension(std::string_view(name, length));
+    static const char suffix[] = ".anims";
+    const size_t suffix_len = sizeof(suffix) - 1;
+    return length >= suffix_len && std::memcmp(name + length - suffix_len, suffix, suffix_len) == 0;
+}
+
+void FindAnim::apply_filter(const ScanFilter::State& state, std::vector<DirItem>& items,
+                            std::vector<ScanFilter::State>& child_states) const
+{
+    child_states.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const std::string name = path_to_utf8(items[i].path.filename());
+        bool keep;
+        if (items[i].is_dir) {
+            ScanFilter::State child;
+            keep = m_filter->enter_dir(state, name, child);
+            if (keep) child_states.push_back(std::move(child));
+        } else {
+            keep = m_filter->accept_file(state, name);
+        }
+        if (keep) {
+            if (kept != i) items[kept] = std::move(items[i]);
+            ++kept;
+        }
+    }
+    items.resize(kept);
+}
+
 bool FindAnim::hasAnimalSuffix(const std::string& filename) {
     const std::string suffix = ".animal";
     if (filename.size() < suffix.size()) return false;
@@ -21,7 +140,137 @@ std::vector<std::string> FindAnim::find_animal_files(
     bool recursive = false             // 是否递归遍历子目录（默认不递归）
 ) {
     std::vector<std::string> result;
-    const std::string suffix = ".anims";
+    walk_animal_files(target_folder, recursive, [&result](std::string&& file) {
+        result.push_back(std::move(file));
+    });
+    return result;
+}
+
+bool FindAnim::walk_animal_files(const std::string& target_folder, bool recursive,
+                                 const std::function<void(std::string&&)>& sink)
+{
+    // 检查目标文件夹是否存在
+    if (!fs::exists(target_folder) || !fs::is_directory(target_folder)) {
+        std::cerr << "错误：文件夹不存在或不是目录 -> " << target_folder << std::endl;
+        return false;
+    }
+
+    // 两种模式都通过 list_directory 列举（Linux 下走 getdents64 后端），
+    // 递归模式按目录项顺序先序展开，与 recursive_directory_iterator 的输出顺序一致
+    // 设置了过滤器时先剪掉被排除的文件和子目录，被排除的子目录不会被打开
+    std::function<void(const fs::path&, const ScanFilter::State&)> walk =
+        [&](const fs::path& dir, const ScanFilter::State& state) {
+        std::vector<DirItem> items;
+        if (!list_directory(dir, items)) return;
+        std::vector<ScanFilter::State> child_states;
+        if (m_filter) apply_filter(state, items, child_states);
+        size_t child = 0;
+        for (const DirItem& item : items) {
+            if (!item.is_dir) {
+                sink(item.path.string());
+            } else if (recursive) {
+                walk(item.path, m_filter ? child_states[child++] : state);
+            }
+        }
+    };
+    walk(fs::path(target_folder), m_filter ? m_filter->root_state() : ScanFilter::State());
+    return true;
+}
+
+bool FindAnim::find_animal_files_table(const std::string& target_folder, bool recursive, PathTable& table)
+{
+    table.clear();
+
+    // 检查目标文件夹是否存在
+    if (!fs::exists(target_folder) || !fs::is_directory(target_folder)) {
+        std::cerr << "错误：文件夹不存在或不是目录 -> " << target_folder << std::endl;
+        return false;
+    }
+
+    std::function<void(const fs::path&, uint32_t, const ScanFilter::State&)> walk =
+        [&](const fs::path& dir, uint32_t dir_id, const ScanFilter::State& state) {
+        std::vector<DirItem> items;
+        if (!list_directory(dir, items)) return;
+        std::vector<ScanFilter::State> child_states;
+        if (m_filter) apply_filter(state, items, child_states);
+        size_t child = 0;
+        for (const DirItem& item : items) {
+            if (!item.is_dir) {
+                table.add_file(dir_id, item.path.filename().string());
+            } else if (recursive) {
+                walk(item.path, table.add_dir(dir_id, item.path.filename().string()),
+                     m_filter ? child_states[child++] : state);
+            }
+        }
+    };
+    walk(fs::path(target_folder), table.add_root(target_folder),
+         m_filter ? m_filter->root_state() : ScanFilter::State());
+    return true;
+}
+
+// 列举单个目录：记录匹配的 .anims 文件和需要继续遍历的子目录（不跟随目录符号链接，与递归迭代器默认行为一致）
+bool FindAnim::list_directory(const fs::path& dir, std::vector<DirItem>& items)
+{
+    ScanCounters* counters = m_stats ? &m_stats->local() : nullptr;
+    const std::chrono::steady_clock::time_point start =
+        counters ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    const size_t first_item = items.size();
+
+#if defined(__linux__)
+    const bool ok = uses_raw_backend() ? list_directory_getdents(dir, items, counters)
+                                       : list_directory_std(dir, items, counters);
+#else
+    const bool ok = list_directory_std(dir, items, counters);
+#endif
+
+    if (counters) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        counters->record_dir_latency(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        uint64_t matches = 0;
+        for (size_t i = first_item; i < items.size(); ++i) {
+            if (!items[i].is_dir) ++matches;
+        }
+        ScanCounters::add(ok ? counters->dirs_opened : counters->errors, 1);
+        ScanCounters::add(counters->matches, matches);
+    }
+    return ok;
+}
+
+bool FindAnim::list_directory_std(const fs::path& dir, std::vector<DirItem>& items, ScanCounters* counters)
+{
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec) {
+        std::cerr << "错误：无法打开目录 -> " << dir.string() << " (" << ec.message() << ")" << std::endl;
+        return false;
+    }
+
+    uint64_t entries = 0;
+    for (fs::directory_iterator end; it != end; it.increment(ec)) {
+        if (ec) break;
+        ++entries;
+        const fs::directory_entry& entry = *it;
+        std::error_code type_ec;
+        if (entry.is_directory(type_ec) && !entry.is_symlink(type_ec)) {
+            items.push_back({entry.path(), true});
+        } else if (entry.is_regular_file(type_ec) &&
+                   (m_filter ? m_filter->match_extension(path_to_utf8(entry.path().filename()))
+                             : has_anims_suffix(entry.path()))) {
+            items.push_back({entry.path(), false});
+        }
+    }
+    if (counters) ScanCounters::add(counters->entries_seen, entries);
+    return true;
+}
+
+// 并行递归查找：每个目录一个任务，子目录由发现它的线程压入自己的队列，空闲线程负责窃取
+std::vector<std::string> FindAnim::find_animal_files_parallel(
+    const std::string& target_folder,  // 目标文件夹路径
+    size_t thread_count,               // 线程数（0 = 硬件线程数）
+    bool keep_order                    // 是否按串行递归遍历的顺序输出
+) {
+    std::vector<std::string> result;
 
     // 检查目标文件夹是否存在
     if (!fs::exists(target_folder) || !fs::is_directory(target_folder)) {
@@ -29,30 +278,227 @@ std::vector<std::string> FindAnim::find_animal_files(
         return result;
     }
 
-    if (recursive) {
-        // 递归遍历：使用 recursive_directory_iterator
-        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(target_folder)) {
-            if (fs::is_regular_file(entry.path())) {  // 传入 path 类型，匹配函数参数
-                std::string filename = entry.path().filename().string();
-                if (filename.size() >= suffix.size() &&
-                    filename.substr(filename.size() - suffix.size()) == suffix) {
-                    result.push_back(entry.path().string());
-                    }
+    WorkStealingPool pool(thread_count);
+    DirNode root;
+    // 不保序时每个工作线程写自己的结果桶，结束后拼接，无需加锁
+    std::vector<std::vector<std::string>> buckets(pool.thread_count());
+
+    std::function<void(fs::path, DirNode*, ScanFilter::State)> walk =
+        [&](fs::path dir, DirNode* node, ScanFilter::State state) {
+        std::vector<DirItem> items;
+        list_directory(dir, items);
+        std::vector<ScanFilter::State> child_states;
+        if (m_filter) apply_filter(state, items, child_states);
+
+        std::vector<std::string>* bucket = keep_order ? nullptr : &buckets[pool.worker_index()];
+        size_t child_index = 0;
+        for (DirItem& item : items) {
+            if (item.is_dir) {
+                DirNode* child = nullptr;
+                if (keep_order) {
+                    node->children.push_back(std::make_unique<DirNode>());
+                    node->order.push_back(true);
+                    child = node->children.back().get();
+                }
+                ScanFilter::State child_state = m_filter ? std::move(child_states[child_index++]) : state;
+                pool.submit([&walk, path = std::move(item.path), child,
+                             child_state = std::move(child_state)]() mutable {
+                    walk(std::move(path), child, std::move(child_state));
+                });
+            } else if (keep_order) {
+                node->files.push_back(item.path.string());
+                node->order.push_back(false);
+            } else {
+                bucket->push_back(item.path.string());
             }
         }
+    };
+
+    ScanFilter::State root_state = m_filter ? m_filter->root_state() : ScanFilter::State();
+    pool.submit([&walk, &root, &target_folder, &root_state] { walk(fs::path(target_folder), &root, root_state); });
+    pool.wait();
+
+    if (keep_order) {
+        flatten_dir_node(root, result);
     } else {
-        // 非递归遍历：使用 directory_iterator
-        for (const fs::directory_entry& entry : fs::directory_iterator(target_folder)) {
-            if (fs::is_regular_file(entry.path())) {  // 传入 path 类型，匹配函数参数
-                std::string filename = entry.path().filename().string();
-                if (filename.size() >= suffix.size() &&
-                    filename.substr(filename.size() - suffix.size()) == suffix) {
-                    result.push_back(entry.path().string());
-                    }
-            }
+        size_t total = 0;
+        for (const auto& bucket : buckets) total += bucket.size();
+        result.reserve(total);
+        for (auto& bucket : buckets) {
+            result.insert(result.end(),
+                          std::make_move_iterator(bucket.begin()),
+                          std::make_move_iterator(bucket.end()));
         }
     }
 
+    return result;
+}
+
+// 增量递归查找：每个目录只做一次 stat 取修改时间，与清单一致则复用记录，否则重新列举该目录
+std::vector<std::string> FindAnim::find_animal_files_incremental(
+    const std::string& target_folder,  // 目标文件夹路径
+    ScanManifest& manifest,            // 上次扫描的清单（输入），本次扫描的清单（输出）
+    bool verbose                       // 是否打印统计
+) {
+    std::vector<std::string> result;
+
+    // 检查目标文件夹是否存在
+    if (!fs::exists(target_folder) || !fs::is_directory(target_folder)) {
+        std::cerr << "错误：文件夹不存在或不是目录 -> " << target_folder << std::endl;
+        return result;
+    }
+
+    ScanManifest previous = std::move(manifest);
+    manifest.clear();
+
+    // 清单中记录的文件受扩展名过滤影响，过滤规则变化后旧清单不能复用
+    const std::string filter_key = m_filter ? m_filter->signature() : std::string();
+    if (previous.filter_key() != filter_key) previous.clear();
+    manifest.set_filter_key(filter_key);
+
+    // 修改时间距扫描开始不足 2 秒的目录可能在同一时间粒度内再次被修改，不记录其时间，下次强制重新列举
+    const fs::file_time_type scan_start = fs::file_time_type::clock::now();
+    const auto racy_window = std::chrono::seconds(2);
+    size_t listed_dirs = 0;
+    size_t reused_dirs = 0;
 
+    std::function<void(const fs::path&, const std::string&, const ScanFilter::State&)> walk =
+        [&](const fs::path& dir, const std::string& key, const ScanFilter::State& state) {
+        std::error_code ec;
+        fs::file_time_type dir_time = fs::last_write_time(dir, ec);
+        if (ec) {
+            std::cerr << "错误：无法读取目录修改时间 -> " << dir.string() << " (" << ec.message() << ")" << std::endl;
+            return;
+        }
+
+        ScanManifest::DirRecord record;
+        const ScanManifest::DirRecord* cached = previous.find(key);
+        if (cached && cached->mtime != 0 && cached->mtime == file_time_to_int(dir_time)) {
+            record = *cached;
+            ++reused_dirs;
+        } else {
+            std::vector<DirItem> items;
+            if (!list_directory(dir, items)) return;
+            ++listed_dirs;
+
+            record.mtime = scan_start - dir_time < racy_window ? 0 : file_time_to_int(dir_time);
+            record.entries.reserve(items.size());
+            for (const DirItem& item : items) {
+                ScanManifest::Entry entry;
+                entry.name = path_to_utf8(item.path.filename());
+                entry.is_dir = item.is_dir;
+                record.entries.push_back(std::move(entry));
+            }
+        }
+
+        // 按目录项原始顺序输出文件、进入子目录，保证结果顺序与全量递归遍历一致
+        for (const ScanManifest::Entry& entry : record.entries) {
+            // 被 exclude 的子目录不进入，其清单记录随之丢弃
+            ScanFilter::State child_state;
+            if (m_filter && (entry.is_dir ? !m_filter->enter_dir(state, entry.name, child_state)
+                                          : !m_filter->accept_file(state, entry.name))) {
+                continue;
+            }
+            fs::path child = dir / path_from_utf8(entry.name);
+            if (entry.is_dir) {
+                walk(child, key.empty() ? entry.name : key + "/" + entry.name, m_filter ? child_state : state);
+            } else {
+                result.push_back(child.string());
+            }
+        }
+        manifest.put(key, std::move(record));
+    };
+
+    walk(fs::path(target_folder), std::string(), m_filter ? m_filter->root_state() : ScanFilter::State());
+
+    if (verbose) {
+        std::cout << "增量扫描：重新列举 " << listed_dirs << " 个目录，复用 " << reused_dirs
+                  << " 个目录的清单记录" << std::endl;
+    }
     return result;
-}
\ No newline at end of file
+}
+
+#if defined(__linux__)
+// Linux 原始遍历后端：getdents64 一次读入大量目录项，直接用 d_type 和名字字节过滤，
+// 只有 d_type 为 DT_UNKNOWN（部分文件系统不提供类型）或 .anims 符号链接时才 stat
+bool FindAnim::list_directory_getdents(const fs::path& dir, std::vector<DirItem>& items,
+                                       ScanCounters* counters)
+{
+    // 与内核 struct linux_dirent64 布局一致
+    struct LinuxDirent64
+    {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    // 系统调用和目录项先累加到局部变量，返回前一次性写入计数器
+    uint64_t syscalls = 1;
+    uint64_t entries = 0;
+
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        if (counters) ScanCounters::add(counters->syscalls, syscalls);
+        std::cerr << "错误：无法打开目录 -> " << dir.string() << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    // 每个线程复用一块大缓冲区，一次系统调用取回数百个目录项
+    thread_local std::vector<char> buffer(128 * 1024);
+    bool ok = true;
+    while (true) {
+        long bytes = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        ++syscalls;
+        if (bytes < 0) {
+            std::cerr << "错误：读取目录失败 -> " << dir.string() << " (" << std::strerror(errno) << ")" << std::endl;
+            ok = false;
+            break;
+        }
+        if (bytes == 0) break;
+
+        for (long offset = 0; offset < bytes;) {
+            const LinuxDirent64* dirent = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+            offset += dirent->d_reclen;
+
+            const char* name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            ++entries;
+            const size_t name_len = std::strlen(name);
+            const bool suffix_match = match_file_name(name, name_len);
+
+            unsigned char type = dirent->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                ++syscalls;
+                if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN;
+            }
+
+            if (type == DT_DIR) {
+                items.push_back({dir / std::string(name, name_len), true});
+            } else if (suffix_match) {
+                // 符号链接按 is_regular_file 的语义跟随到目标再判断
+                if (type == DT_LNK) {
+                    struct stat st;
+                    ++syscalls;
+                    if (::fstatat(fd, name, &st, 0) != 0 || !S_ISREG(st.st_mode)) continue;
+                    type = DT_REG;
+                }
+                if (type == DT_REG) {
+                    items.push_back({dir / std::string(name, name_len), false});
+                }
+            }
+        }
+    }
+
+    ::close(fd);
+    ++syscalls;
+    if (counters) {
+        ScanCounters::add(counters->syscalls, syscalls);
+        ScanCounters::add(counters->entries_seen, entries);
+    }
+    return ok;
+}
+#endif
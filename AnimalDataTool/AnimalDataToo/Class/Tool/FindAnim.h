@@ -1,12 +1,80 @@
 ﻿#pragma once
+#include <functional>
 #include <vector>
-#include <xstring>
+#include <string>
 #include <filesystem>  // C++17 原生文件系统库
 namespace fs = std::filesystem;  // 简化命名空间
+
+#include "ScanFilter.h"
+
+class PathTable;
+class ScanManifest;
+class ScanStats;
+struct ScanCounters;
+
+// 目录列举后端：Auto 在 Linux 下使用 getdents64 原始遍历，其他平台使用 std::filesystem
+enum class ScanBackend
+{
+    Auto,
+    StdFilesystem,
+    LinuxGetdents,
+};
+
 class FindAnim
 {
 public:
     FindAnim();
+    void set_backend(ScanBackend backend);
+    // 设置后每次列举目录都会累加当前线程的计数器和列举耗时直方图；传 nullptr 关闭
+    void set_stats(ScanStats* stats) { m_stats = stats; }
+    // 设置后用过滤器的扩展名集合代替 .anims 后缀判断，并在遍历时按 include/exclude 剪枝（filter 须已编译）；
+    // 监视模式不使用过滤器。传 nullptr 恢复默认
+    void set_filter(const ScanFilter* filter) { m_filter = filter; }
     bool hasAnimalSuffix(const std::string& filename);
     std::vector<std::string> find_animal_files(const std::string& target_folder, bool recursive);
+
+    // 流式查找：顺序与 find_animal_files 相同，但每找到一个文件就交给 sink，不保留结果列表
+    bool walk_animal_files(const std::string& target_folder, bool recursive,
+                           const std::function<void(std::string&&)>& sink);
+
+    // 查找结果写入前缀压缩的路径表（目录只登记一次，不保存完整路径字符串），顺序与 find_animal_files 相同
+    bool find_animal_files_table(const std::string& target_folder, bool recursive, PathTable& table);
+
+    // 并行递归查找：每个子目录作为一个任务投递到工作窃取线程池
+    // thread_count 为 0 时使用全部硬件线程；keep_order 为 true 时结果顺序与 find_animal_files 递归模式一致
+    std::vector<std::string> find_animal_files_parallel(const std::string& target_folder,
+                                                        size_t thread_count = 0,
+                                                        bool keep_order = true);
+
+    // 增量递归查找：修改时间未变的目录直接复用 manifest 中的记录，只重新列举有变化的目录；
+    // 结果与全量递归遍历一致，manifest 会被更新为本次扫描的状态（由调用方负责加载/保存）
+    // verbose 为 false 时不打印列举/复用的目录数（监视模式轮询时使用）
+    std::vector<std::string> find_animal_files_incremental(const std::string& target_folder,
+                                                           ScanManifest& manifest,
+                                                           bool verbose = true);
+
+    // 单个目录的列举结果，items 按目录项原始顺序记录（is_dir 区分子目录与 .anims 文件）
+    struct DirItem
+    {
+        fs::path path;
+        bool is_dir;
+    };
+
+    // 列举单个目录（非递归），供各种遍历方式和监视模式复用
+    bool list_directory(const fs::path& dir, std::vector<DirItem>& items);
+
+private:
+    bool uses_raw_backend() const;
+    bool match_file_name(const char* name, size_t length) const;
+    // 按过滤器移除 dir（匹配状态为 state）中被排除的文件和子目录，保留的子目录状态按顺序写入 child_states
+    void apply_filter(const ScanFilter::State& state, std::vector<DirItem>& items,
+                      std::vector<ScanFilter::State>& child_states) const;
+    bool list_directory_std(const fs::path& dir, std::vector<DirItem>& items, ScanCounters* counters);
+#if defined(__linux__)
+    bool list_directory_getdents(const fs::path& dir, std::vector<DirItem>& items, ScanCounters* counters);
+#endif
+
+    ScanBackend m_backend = ScanBackend::Auto;
+    ScanStats* m_stats = nullptr;
+    const ScanFilter* m_filter = nullptr;
 };
@@ -0,0 +1,161 @@
+﻿#include "MappedFile.h"
+
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept
+{
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_open, other.m_open);
+#if defined(_WIN32)
+    std::swap(m_file, other.m_file);
+    std::swap(m_mapping, other.m_mapping);
+#endif
+}
+
+#if defined(_WIN32)
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    // 经 fs::path 转成宽字符路径，支持非 ASCII 文件名
+    HANDLE file = ::CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "错误：无法打开文件 -> " << path << " (错误码 " << ::GetLastError() << ")" << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size)) {
+        std::cerr << "错误：无法获取文件大小 -> " << path << std::endl;
+        ::CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_open = true;
+    if (m_size == 0) return true;
+
+    HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        std::cerr << "错误：无法映射文件 -> " << path << " (错误码 " << ::GetLastError() << ")" << std::endl;
+        close();
+        return false;
+    }
+    m_mapping = mapping;
+
+    m_data = static_cast<const uint8_t*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        std::cerr << "错误：无法映射文件视图 -> " << path << " (错误码 " << ::GetLastError() << ")" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data) ::UnmapViewOfFile(m_data);
+    if (m_mapping) ::CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file) ::CloseHandle(static_cast<HANDLE>(m_file));
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+void MappedFile::advise_random()
+{
+    // 映射视图按需分页，预读粒度较小，无需额外处理
+}
+#else
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "错误：无法打开文件 -> " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::cerr << "错误：无法获取文件大小 -> " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    m_open = true;
+    if (m_size > 0) {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            std::cerr << "错误：无法映射文件 -> " << path << " (" << std::strerror(errno) << ")" << std::endl;
+            ::close(fd);
+            m_size = 0;
+            m_open = false;
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+    }
+    // 映射建立后即可关闭描述符
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data) ::munmap(const_cast<uint8_t*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+void MappedFile::advise_random()
+{
+    if (m_data) ::madvise(const_cast<uint8_t*>(m_data), m_size, MADV_RANDOM);
+}
+#endif
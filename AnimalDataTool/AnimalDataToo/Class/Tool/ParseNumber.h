@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+// 整个字符串是 T 范围内的十进制无符号整数时写入 value 并返回 true（空串、符号、空白和多余字符都不接受）
+template <typename T>
+inline bool parse_unsigned(std::string_view text, T& value)
+{
+    static_assert(std::is_unsigned<T>::value, "parse_unsigned 只解析无符号整数");
+    const char* end = text.data() + text.size();
+    const std::from_chars_result result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
@@ -0,0 +1,185 @@
+﻿#include "PathTable.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    bool is_separator(char c)
+    {
+#if defined(_WIN32)
+        return c == '\\' || c == '/';
+#else
+        return c == '/';
+#endif
+    }
+}
+
+PathTable::PathTable()
+{
+}
+
+void PathTable::clear()
+{
+    m_dirs.clear();
+    m_files.clear();
+    m_names.clear();
+}
+
+void PathTable::reserve(size_t dirs, size_t files, size_t name_bytes)
+{
+    m_dirs.reserve(dirs);
+    m_files.reserve(files);
+    m_names.reserve(name_bytes);
+}
+
+uint32_t PathTable::intern_name(std::string_view name)
+{
+    uint32_t offset = static_cast<uint32_t>(m_names.size());
+    m_names.append(name.data(), name.size());
+    return offset;
+}
+
+uint32_t PathTable::add_root(std::string_view root_path)
+{
+    DirNode node;
+    node.parent = kNoParent;
+    node.name_offset = intern_name(root_path);
+    node.name_length = static_cast<uint32_t>(root_path.size());
+    node.depth = 0;
+    m_dirs.push_back(node);
+    return static_cast<uint32_t>(m_dirs.size() - 1);
+}
+
+uint32_t PathTable::add_dir(uint32_t parent, std::string_view name)
+{
+    DirNode node;
+    node.parent = parent;
+    node.name_offset = intern_name(name);
+    node.name_length = static_cast<uint32_t>(name.size());
+    node.depth = m_dirs[parent].depth + 1;
+    m_dirs.push_back(node);
+    return static_cast<uint32_t>(m_dirs.size() - 1);
+}
+
+uint32_t PathTable::add_file(uint32_t dir, std::string_view name)
+{
+    FileEntry entry;
+    entry.dir = dir;
+    entry.name_offset = intern_name(name);
+    entry.name_length = static_cast<uint32_t>(name.size());
+    m_files.push_back(entry);
+    return static_cast<uint32_t>(m_files.size() - 1);
+}
+
+std::string_view PathTable::dir_name(uint32_t dir) const
+{
+    const DirNode& node = m_dirs[dir];
+    return std::string_view(m_names.data() + node.name_offset, node.name_length);
+}
+
+std::string_view PathTable::file_name(uint32_t file) const
+{
+    const FileEntry& entry = m_files[file];
+    return std::string_view(m_names.data() + entry.name_offset, entry.name_length);
+}
+
+std::string_view PathTable::file_name_of(std::string_view path)
+{
+#if defined(_WIN32)
+    size_t begin = path.find_last_of("\\/");
+    if (begin == std::string_view::npos && path.size() >= 2 && path[1] == ':') begin = 1;
+#else
+    size_t begin = path.rfind('/');
+#endif
+    return begin == std::string_view::npos ? path : path.substr(begin + 1);
+}
+
+void PathTable::append_dir_chain(uint32_t dir, std::string& out, bool include_root, char separator) const
+{
+    // 先收集从当前目录到根目录的链，再从根往下拼接；链的深度不设上限，缓冲区按线程复用
+    thread_local std::vector<uint32_t> chain;
+    chain.clear();
+    for (uint32_t id = dir; id != kNoParent; id = m_dirs[id].parent) {
+        chain.push_back(id);
+    }
+    size_t count = chain.size();
+
+    bool first = true;
+    while (count > 0) {
+        uint32_t id = chain[--count];
+        if (m_dirs[id].parent == kNoParent && !include_root) continue;
+        if (!first && !out.empty() && !is_separator(out.back())) {
+            out.push_back(separator);
+        }
+        std::string_view name = dir_name(id);
+        out.append(name.data(), name.size());
+        first = false;
+    }
+}
+
+void PathTable::append_dir_path(uint32_t dir, std::string& out) const
+{
+    append_dir_chain(dir, out, true, kSeparator);
+}
+
+void PathTable::append_full_path(uint32_t file, std::string& out) const
+{
+    const size_t start = out.size();
+    append_dir_chain(m_files[file].dir, out, true, kSeparator);
+    if (out.size() > start && !is_separator(out.back())) {
+        out.push_back(kSeparator);
+    }
+    std::string_view name = file_name(file);
+    out.append(name.data(), name.size());
+}
+
+std::string PathTable::full_path(uint32_t file) const
+{
+    std::string path;
+    append_full_path(file, path);
+    return path;
+}
+
+void PathTable::append_relative_path(uint32_t file, std::string& out) const
+{
+    const size_t start = out.size();
+    append_dir_chain(m_files[file].dir, out, false, '/');
+    if (out.size() > start) {
+        out.push_back('/');
+    }
+    std::string_view name = file_name(file);
+    out.append(name.data(), name.size());
+}
+
+std::vector<uint32_t> PathTable::sorted_files() const
+{
+    // 目录名次：每个目录只拼一次完整路径并排序
+    std::vector<std::string> dir_paths(m_dirs.size());
+    for (uint32_t dir = 0; dir < m_dirs.size(); ++dir) {
+        append_dir_path(dir, dir_paths[dir]);
+    }
+    std::vector<uint32_t> dir_order(m_dirs.size());
+    std::iota(dir_order.begin(), dir_order.end(), 0u);
+    std::sort(dir_order.begin(), dir_order.end(),
+              [&](uint32_t a, uint32_t b) { return dir_paths[a] < dir_paths[b]; });
+    std::vector<uint32_t> dir_rank(m_dirs.size());
+    for (uint32_t rank = 0; rank < dir_order.size(); ++rank) {
+        dir_rank[dir_order[rank]] = rank;
+    }
+
+    std::vector<uint32_t> files(m_files.size());
+    std::iota(files.begin(), files.end(), 0u);
+    std::sort(files.begin(), files.end(), [&](uint32_t a, uint32_t b) {
+        uint32_t rank_a = dir_rank[m_files[a].dir];
+        uint32_t rank_b = dir_rank[m_files[b].dir];
+        if (rank_a != rank_b) return rank_a < rank_b;
+        return file_name(a) < file_name(b);
+    });
+    return files;
+}
+
+size_t PathTable::memory_bytes() const
+{
+    return m_dirs.size() * sizeof(DirNode) + m_files.size() * sizeof(FileEntry) + m_names.size();
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 前缀压缩的路径表：目录按父子关系各登记一次，文件只记录 (目录ID, 文件名在字符池中的位置)，
+// 所有名字连续存放在同一个字符池里；完整路径只在输出时拼接。
+// 与 vector<string> 保存绝对路径相比，每个文件只多占 12 字节加上文件名本身。
+class PathTable
+{
+public:
+    static constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+
+#if defined(_WIN32)
+    static constexpr char kSeparator = '\\';
+#else
+    static constexpr char kSeparator = '/';
+#endif
+
+    PathTable();
+
+    void clear();
+    void reserve(size_t dirs, size_t files, size_t name_bytes);
+
+    // 根目录以完整路径作为名字登记，其余目录只登记目录名
+    uint32_t add_root(std::string_view root_path);
+    uint32_t add_dir(uint32_t parent, std::string_view name);
+    uint32_t add_file(uint32_t dir, std::string_view name);
+
+    size_t dir_count() const { return m_dirs.size(); }
+    size_t file_count() const { return m_files.size(); }
+
+    uint32_t dir_parent(uint32_t dir) const { return m_dirs[dir].parent; }
+    uint32_t dir_depth(uint32_t dir) const { return m_dirs[dir].depth; }
+    std::string_view dir_name(uint32_t dir) const;
+    uint32_t file_dir(uint32_t file) const { return m_files[file].dir; }
+    std::string_view file_name(uint32_t file) const;
+
+    // 与 fs::path(path).filename() 相同（Windows 上 '\\'、'/' 都是分隔符，"X:" 盘符不属于文件名），不构造 fs::path
+    static std::string_view file_name_of(std::string_view path);
+
+    // 拼接路径（追加到 out 末尾，便于复用缓冲区）；分隔符与 fs::path 的 operator/ 一致
+    void append_dir_path(uint32_t dir, std::string& out) const;
+    void append_full_path(uint32_t file, std::string& out) const;
+    std::string full_path(uint32_t file) const;
+
+    // 相对根目录的路径，使用 '/' 分隔（与 AnimsClassifier::extractRelativePath 的输出格式一致）
+    void append_relative_path(uint32_t file, std::string& out) const;
+
+    // 返回按 (目录路径, 文件名) 排序的文件ID：目录只排序一次，文件比较整数名次和短文件名
+    std::vector<uint32_t> sorted_files() const;
+
+    // 表本身占用的内存（不含 vector 的空闲容量）
+    size_t memory_bytes() const;
+
+private:
+    struct DirNode
+    {
+        uint32_t parent;
+        uint32_t name_offset;
+        uint32_t name_length;
+        uint32_t depth;  // 根目录为 0
+    };
+
+    struct FileEntry
+    {
+        uint32_t dir;
+        uint32_t name_offset;
+        uint32_t name_length;
+    };
+
+    uint32_t intern_name(std::string_view name);
+    void append_dir_chain(uint32_t dir, std::string& out, bool include_root, char separator) const;
+
+    std::vector<DirNode> m_dirs;
+    std::vector<FileEntry> m_files;
+    std::string m_names;  // 字符池
+};
@@ -0,0 +1,269 @@
+﻿#include "ScanFilter.h"
+
+#include <algorithm>
+
+#include "StringKernels.h"
+
+namespace
+{
+    // 统一分隔符，去掉开头的 "./" 和 "/" 以及末尾的 "/"
+    std::string normalize_glob(std::string glob)
+    {
+        std::replace(glob.begin(), glob.end(), '\\', '/');
+        while (glob.compare(0, 2, "./") == 0) glob.erase(0, 2);
+        while (!glob.empty() && glob.front() == '/') glob.erase(0, 1);
+        while (!glob.empty() && glob.back() == '/') glob.pop_back();
+        return glob;
+    }
+
+    void append_list(std::string& out, const char* key, const std::vector<std::string>& values)
+    {
+        out += key;
+        out += '=';
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) out += '|';
+            out += values[i];
+        }
+        out += ';';
+    }
+}
+
+ScanFilter::ScanFilter()
+{
+    m_extensions.push_back(".anims");
+    compile();
+}
+
+void ScanFilter::add_include(const std::string& glob)
+{
+    m_includes.push_back(normalize_glob(glob));
+}
+
+void ScanFilter::add_exclude(const std::string& glob)
+{
+    m_excludes.push_back(normalize_glob(glob));
+}
+
+void ScanFilter::add_extension(const std::string& ext)
+{
+    if (!m_customExtensions) {
+        m_extensions.clear();
+        m_customExtensions = true;
+    }
+    m_extensions.push_back(!ext.empty() && ext[0] == '.' ? ext : "." + ext);
+}
+
+void ScanFilter::set_case_sensitive(bool case_sensitive)
+{
+    m_caseSensitive = case_sensitive;
+}
+
+char ScanFilter::fold(char c) const
+{
+    if (!m_caseSensitive && c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+    return c;
+}
+
+void ScanFilter::add_glob(const std::string& glob, bool exclude)
+{
+    // 不含 '/' 的 glob 可以出现在任意层级，等价于前面加 "**/"
+    const std::string pattern = glob.find('/') == std::string::npos ? "**/" + glob : glob;
+
+    m_starts.push_back(static_cast<uint32_t>(m_states.size()));
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        NfaState state;
+        state.ch = 0;
+        state.exclude = exclude;
+        const char c = pattern[i];
+        if (c == '*' && i + 1 < pattern.size() && pattern[i + 1] == '*') {
+            // 连续的 * 视为一个 **，紧跟 '/' 时可以匹配零个目录
+            while (i + 1 < pattern.size() && pattern[i + 1] == '*') ++i;
+            if (i + 1 < pattern.size() && pattern[i + 1] == '/') {
+                state.kind = TokenKind::AnyDirs;
+                ++i;
+            } else {
+                state.kind = TokenKind::AnyPath;
+            }
+        } else if (c == '*') {
+            state.kind = TokenKind::Star;
+        } else if (c == '?') {
+            state.kind = TokenKind::AnyChar;
+        } else {
+            state.kind = TokenKind::Literal;
+            state.ch = fold(c);
+        }
+        m_states.push_back(state);
+    }
+
+    NfaState accept;
+    accept.kind = TokenKind::Accept;
+    accept.ch = 0;
+    accept.exclude = exclude;
+    m_states.push_back(accept);
+}
+
+void ScanFilter::compile()
+{
+    m_states.clear();
+    m_starts.clear();
+    for (const std::string& glob : m_includes) add_glob(glob, false);
+    for (const std::string& glob : m_excludes) add_glob(glob, true);
+
+    m_words = (m_states.size() + 63) / 64;
+    m_includeAccept.assign(m_words, 0);
+    m_excludeAccept.assign(m_words, 0);
+    m_includeLive.assign(m_words, 0);
+    for (size_t i = 0; i < m_states.size(); ++i) {
+        const uint64_t bit = uint64_t(1) << (i % 64);
+        if (!m_states[i].exclude) m_includeLive[i / 64] |= bit;
+        if (m_states[i].kind != TokenKind::Accept) continue;
+        (m_states[i].exclude ? m_excludeAccept : m_includeAccept)[i / 64] |= bit;
+    }
+
+    // 扩展名反向插入后缀树，节点 0 为根
+    m_suffixNext.assign(1, std::array<int32_t, 256>());
+    m_suffixNext[0].fill(-1);
+    m_suffixTerminal.assign(1, 0);
+    for (const std::string& ext : m_extensions) {
+        int32_t node = 0;
+        for (size_t i = ext.size(); i-- > 0;) {
+            const unsigned char c = static_cast<unsigned char>(fold(ext[i]));
+            if (m_suffixNext[node][c] < 0) {
+                m_suffixNext[node][c] = static_cast<int32_t>(m_suffixNext.size());
+                m_suffixNext.emplace_back();
+                m_suffixNext.back().fill(-1);
+                m_suffixTerminal.push_back(0);
+            }
+            node = m_suffixNext[node][c];
+        }
+        m_suffixTerminal[node] = 1;
+    }
+}
+
+void ScanFilter::add_closure(uint32_t state, std::vector<uint64_t>& set) const
+{
+    // *、**、**/ 都可以匹配空串，直接连到下一个状态
+    while (true) {
+        set[state / 64] |= uint64_t(1) << (state % 64);
+        const TokenKind kind = m_states[state].kind;
+        if (kind != TokenKind::Star && kind != TokenKind::AnyPath && kind != TokenKind::AnyDirs) break;
+        ++state;
+    }
+}
+
+void ScanFilter::step(const std::vector<uint64_t>& from, char c, std::vector<uint64_t>& to) const
+{
+    std::fill(to.begin(), to.end(), 0);
+    const char folded = fold(c);
+    for (size_t word = 0; word < from.size(); ++word) {
+        for (uint64_t bits = from[word]; bits != 0; bits &= bits - 1) {
+            const uint32_t state = static_cast<uint32_t>(word * 64 + StringKernels::lowestBit(bits));
+            const NfaState& nfa = m_states[state];
+            switch (nfa.kind) {
+            case TokenKind::Literal:
+                if (nfa.ch == folded) add_closure(state + 1, to);
+                break;
+            case TokenKind::AnyChar:
+                if (c != '/') add_closure(state + 1, to);
+                break;
+            case TokenKind::Star:
+                if (c != '/') add_closure(state, to);
+                break;
+            case TokenKind::AnyPath:
+                add_closure(state, to);
+                break;
+            case TokenKind::AnyDirs:
+                add_closure(state, to);
+                if (c == '/') add_closure(state + 1, to);
+                break;
+            case TokenKind::Accept:
+                break;
+            }
+        }
+    }
+}
+
+void ScanFilter::feed(std::vector<uint64_t>& set, std::string_view text) const
+{
+    std::vector<uint64_t> next(m_words);
+    for (char c : text) {
+        step(set, c, next);
+        set.swap(next);
+    }
+}
+
+bool ScanFilter::intersects(const std::vector<uint64_t>& set, const std::vector<uint64_t>& mask) const
+{
+    for (size_t i = 0; i < set.size(); ++i) {
+        if (set[i] & mask[i]) return true;
+    }
+    return false;
+}
+
+ScanFilter::State ScanFilter::root_state() const
+{
+    State state;
+    state.active.assign(m_words, 0);
+    for (uint32_t start : m_starts) add_closure(start, state.active);
+    state.include_all = m_includes.empty();
+    return state;
+}
+
+bool ScanFilter::enter_dir(const State& parent, std::string_view name, State& child) const
+{
+    child.active = parent.active;
+    feed(child.active, name);
+    if (intersects(child.active, m_excludeAccept)) return false;
+
+    child.include_all = parent.include_all || intersects(child.active, m_includeAccept);
+    feed(child.active, "/");
+    // 子树中不可能再有文件命中 include
+    return child.include_all || intersects(child.active, m_includeLive);
+}
+
+bool ScanFilter::accept_file(const State& dir, std::string_view name) const
+{
+    if (m_states.empty()) return true;
+    std::vector<uint64_t> set = dir.active;
+    feed(set, name);
+    if (intersects(set, m_excludeAccept)) return false;
+    return dir.include_all || intersects(set, m_includeAccept);
+}
+
+bool ScanFilter::match_extension(std::string_view name) const
+{
+    int32_t node = 0;
+    for (size_t i = name.size(); i-- > 0;) {
+        node = m_suffixNext[node][static_cast<unsigned char>(fold(name[i]))];
+        if (node < 0) return false;
+        if (m_suffixTerminal[node]) return true;
+    }
+    return false;
+}
+
+bool ScanFilter::accept_path(std::string_view path) const
+{
+    State state = root_state();
+    State child;
+    size_t begin = 0;
+    for (size_t end = path.find_first_of("\\/"); end != std::string_view::npos; end = path.find_first_of("\\/", begin)) {
+        // 连续的分隔符不构成目录名
+        if (end > begin) {
+            if (!enter_dir(state, path.substr(begin, end - begin), child)) return false;
+            std::swap(state, child);
+        }
+        begin = end + 1;
+    }
+    const std::string_view name = path.substr(begin);
+    return match_extension(name) && accept_file(state, name);
+}
+
+std::string ScanFilter::signature() const
+{
+    std::string text;
+    append_list(text, "ext", m_extensions);
+    append_list(text, "include", m_includes);
+    append_list(text, "exclude", m_excludes);
+    text += m_caseSensitive ? "case=1" : "case=0";
+    return text;
+}
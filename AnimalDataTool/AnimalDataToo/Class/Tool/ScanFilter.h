@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 遍历过滤器：include/exclude glob 和扩展名集合在 compile() 时编译成一个 NFA 和一棵反向后缀树。
+// glob 匹配相对扫描根目录、以 '/' 分隔的路径，支持 *（不跨目录）、?、**（跨目录）；
+// 不含 '/' 的 glob 匹配任意层级的名字（例如 marketing、test*），含 '/' 的从根目录开始匹配。
+// 遍历时每个目录保存自己的 NFA 状态，子目录/文件只需在父目录状态上继续读入自己的名字：
+//   - 目录名命中 exclude：整个子树跳过，不会被打开
+//   - 存在 include 时，目录名命中 include 则其下全部收录；读入 "名字/" 后没有任何 include 状态存活的目录同样跳过
+class ScanFilter
+{
+public:
+    // 某个目录的匹配状态（已读入 "目录相对路径/"）
+    struct State
+    {
+        std::vector<uint64_t> active;  // NFA 活动状态位图
+        bool include_all = false;      // 祖先目录已命中 include
+    };
+
+    ScanFilter();
+
+    void add_include(const std::string& glob);
+    void add_exclude(const std::string& glob);
+    // 首次调用时替换默认的 .anims；ext 可以带或不带开头的 '.'
+    void add_extension(const std::string& ext);
+    // 默认区分大小写（与未设置过滤器时的 .anims 后缀判断一致）
+    void set_case_sensitive(bool case_sensitive);
+
+    // 修改规则后必须重新编译
+    void compile();
+
+    State root_state() const;
+    // 是否进入子目录 name；返回 true 时 child 为子目录的状态
+    bool enter_dir(const State& parent, std::string_view name, State& child) const;
+    // 目录 dir 下的文件 name 是否收录（不检查扩展名）
+    bool accept_file(const State& dir, std::string_view name) const;
+    // 从名字末尾反向读一遍字节判断扩展名
+    bool match_extension(std::string_view name) const;
+    // 不经过目录遍历的文件路径（相对扫描根目录，'/' 或 '\\' 分隔）是否收录：逐级 enter_dir，再检查文件名和扩展名
+    bool accept_path(std::string_view path) const;
+
+    // 规则的文本摘要，规则不同则摘要不同（用于判断增量扫描清单是否可以复用）
+    std::string signature() const;
+
+private:
+    enum class TokenKind : uint8_t
+    {
+        Literal,
+        AnyChar,      // ?
+        Star,         // *
+        AnyPath,      // ** 不在目录分隔处
+        AnyDirs,      // **/ 匹配零个或多个完整目录
+        Accept,
+    };
+
+    struct NfaState
+    {
+        TokenKind kind;
+        char ch;
+        bool exclude;
+    };
+
+    void add_glob(const std::string& glob, bool exclude);
+    char fold(char c) const;
+    void add_closure(uint32_t state, std::vector<uint64_t>& set) const;
+    void step(const std::vector<uint64_t>& from, char c, std::vector<uint64_t>& to) const;
+    void feed(std::vector<uint64_t>& set, std::string_view text) const;
+    bool intersects(const std::vector<uint64_t>& set, const std::vector<uint64_t>& mask) const;
+
+    std::vector<std::string> m_includes;
+    std::vector<std::string> m_excludes;
+    std::vector<std::string> m_extensions;
+    bool m_customExtensions = false;
+    bool m_caseSensitive = true;
+
+    // 编译结果
+    std::vector<NfaState> m_states;
+    std::vector<uint32_t> m_starts;
+    std::vector<uint64_t> m_includeAccept;
+    std::vector<uint64_t> m_excludeAccept;
+    std::vector<uint64_t> m_includeLive;  // 所有 include 状态
+    size_t m_words = 0;
+
+    // 反向后缀树：从名字最后一个字节开始逐字节下行，到达终止节点即命中
+    std::vector<std::array<int32_t, 256>> m_suffixNext;
+    std::vector<uint8_t> m_suffixTerminal;
+};
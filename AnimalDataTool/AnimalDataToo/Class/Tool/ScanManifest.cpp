@@ -0,0 +1,168 @@
+﻿#include "ScanManifest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // 版本 2：去掉文件的大小和修改时间，名字转义
+    const char* kManifestHeader = "ANIMSCAN 2";
+
+    // 反斜杠、制表符、回车、换行写成反斜杠加 \\、t、r、n，保证一条记录占一行、字段不被拆开
+    void append_escaped(std::string& out, const std::string& text)
+    {
+        for (char c : text) {
+            switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out.push_back(c); break;
+            }
+        }
+    }
+
+    // 未知的转义序列视为清单损坏，返回 false
+    bool unescape(const std::string& text, std::string& out)
+    {
+        out.clear();
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] != '\\') {
+                out.push_back(text[i]);
+                continue;
+            }
+            if (++i == text.size()) return false;
+            switch (text[i]) {
+            case '\\': out.push_back('\\'); break;
+            case 't': out.push_back('\t'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            default: return false;
+            }
+        }
+        return true;
+    }
+}
+
+ScanManifest::ScanManifest()
+{
+}
+
+std::string ScanManifest::path_for_csv(const std::string& csv_output_path)
+{
+    return csv_output_path + ".manifest";
+}
+
+const ScanManifest::DirRecord* ScanManifest::find(const std::string& key) const
+{
+    auto it = m_dirs.find(key);
+    return it != m_dirs.end() ? &it->second : nullptr;
+}
+
+void ScanManifest::put(const std::string& key, DirRecord record)
+{
+    m_dirs[key] = std::move(record);
+}
+
+void ScanManifest::clear()
+{
+    m_dirs.clear();
+    m_filterKey.clear();
+}
+
+// 文本格式，每行一条记录，字段用制表符分隔：
+//   K <过滤规则摘要>（可选，紧跟文件头）
+//   D <mtime> <目录key>
+//   S <子目录名>
+//   F <文件名>
+// S/F 行属于最近的 D 行，顺序即目录项原始顺序；摘要、key 和名字都经过 append_escaped 转义
+bool ScanManifest::load(const std::string& manifest_path)
+{
+    clear();
+
+    std::ifstream file(manifest_path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kManifestHeader) {
+        std::cerr << "警告：扫描清单格式不符，将执行全量扫描 -> " << manifest_path << std::endl;
+        return false;
+    }
+
+    DirRecord* current = nullptr;
+    std::string text;
+    bool valid = true;
+    try {
+        while (valid && std::getline(file, line)) {
+            if (line.size() < 2 || line[1] != '\t') continue;
+            const char kind = line[0];
+            const std::string rest = line.substr(2);
+
+            if (kind == 'K') {
+                valid = unescape(rest, m_filterKey);
+            } else if (kind == 'D') {
+                size_t tab = rest.find('\t');
+                if (tab == std::string::npos) { current = nullptr; continue; }
+                valid = unescape(rest.substr(tab + 1), text);
+                DirRecord& record = m_dirs[text];
+                record.mtime = std::stoll(rest.substr(0, tab));
+                record.entries.clear();
+                current = &record;
+            } else if ((kind == 'S' || kind == 'F') && current) {
+                Entry entry;
+                valid = unescape(rest, entry.name);
+                entry.is_dir = kind == 'S';
+                current->entries.push_back(std::move(entry));
+            }
+        }
+    } catch (const std::exception&) {
+        // 数字字段损坏
+        valid = false;
+    }
+    if (!valid) {
+        // 丢弃整个清单，退回全量扫描
+        std::cerr << "警告：扫描清单已损坏，将执行全量扫描 -> " << manifest_path << std::endl;
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool ScanManifest::save(const std::string& manifest_path) const
+{
+    std::ofstream file(manifest_path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "错误：无法写入扫描清单 -> " << manifest_path << std::endl;
+        return false;
+    }
+
+    // 按 key 排序输出，保证同一棵目录树生成的清单内容稳定
+    std::vector<const std::pair<const std::string, DirRecord>*> sorted;
+    sorted.reserve(m_dirs.size());
+    for (const auto& dir : m_dirs) sorted.push_back(&dir);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::string out;
+    out.append(kManifestHeader).push_back('\n');
+    if (!m_filterKey.empty()) {
+        out += "K\t";
+        append_escaped(out, m_filterKey);
+        out.push_back('\n');
+    }
+    for (const auto* dir : sorted) {
+        out.append("D\t").append(std::to_string(dir->second.mtime)).push_back('\t');
+        append_escaped(out, dir->first);
+        out.push_back('\n');
+        for (const Entry& entry : dir->second.entries) {
+            out += entry.is_dir ? "S\t" : "F\t";
+            append_escaped(out, entry.name);
+            out.push_back('\n');
+        }
+    }
+    file << out;
+    return file.good();
+}
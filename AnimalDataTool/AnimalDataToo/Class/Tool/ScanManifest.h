@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 扫描清单：记录每个目录的修改时间及其中的子目录和 .anims 文件名，
+// 保存在 CSV 旁边，下次扫描时目录修改时间未变的目录直接复用记录，不再列举。
+// 清单只用于还原文件列表：文件内容变化不改变目录修改时间，因此不记录文件的大小和修改时间
+class ScanManifest
+{
+public:
+    struct Entry
+    {
+        std::string name;    // UTF-8 文件名/目录名
+        bool is_dir = false;
+    };
+
+    struct DirRecord
+    {
+        int64_t mtime = 0;            // 目录修改时间，0 表示下次必须重新列举
+        std::vector<Entry> entries;   // 按目录项原始顺序
+    };
+
+    ScanManifest();
+
+    // 清单文件不存在或格式不符时返回 false，清单保持为空（即全量扫描）
+    bool load(const std::string& manifest_path);
+    bool save(const std::string& manifest_path) const;
+
+    // key 为相对扫描根目录的路径（'/' 分隔，根目录为空串）
+    const DirRecord* find(const std::string& key) const;
+    void put(const std::string& key, DirRecord record);
+    void clear();
+    size_t size() const { return m_dirs.size(); }
+
+    // 生成清单时使用的过滤规则摘要（未设置过滤器时为空）
+    const std::string& filter_key() const { return m_filterKey; }
+    void set_filter_key(const std::string& key) { m_filterKey = key; }
+
+    // 清单默认放在 CSV 旁边
+    static std::string path_for_csv(const std::string& csv_output_path);
+
+private:
+    std::unordered_map<std::string, DirRecord> m_dirs;
+    std::string m_filterKey;
+};
@@ -0,0 +1,252 @@
+﻿#include "ScanStats.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<uint64_t> g_nextStatsId{1};
+
+    // 每个线程缓存最近使用的 ScanStats 实例及其计数器，避免每次都加锁查找
+    struct LocalSlotCache
+    {
+        uint64_t owner = 0;
+        ScanCounters* counters = nullptr;
+    };
+    thread_local LocalSlotCache t_slotCache;
+
+    uint64_t load(const std::atomic<uint64_t>& counter)
+    {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    // 桶 i 的上界（微秒），溢出桶返回 0
+    uint64_t bucket_upper_us(size_t bucket)
+    {
+        return bucket + 1 < kScanLatencyBuckets ? (uint64_t(1) << bucket) : 0;
+    }
+
+    double per_second(uint64_t value, double seconds)
+    {
+        return seconds > 0.0 ? value / seconds : 0.0;
+    }
+
+    std::string json_escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+}
+
+ScanCounters::ScanCounters()
+{
+    for (std::atomic<uint64_t>& bucket : latency_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ScanCounters::record_dir_latency(uint64_t nanoseconds)
+{
+    add(latency_ns, nanoseconds);
+    uint64_t us = nanoseconds / 1000;
+    size_t bucket = 0;
+    while (us != 0 && bucket + 1 < kScanLatencyBuckets) {
+        us >>= 1;
+        ++bucket;
+    }
+    add(latency_buckets[bucket], 1);
+}
+
+ScanStats::ScanStats()
+    : m_id(g_nextStatsId.fetch_add(1)), m_start(Clock::now())
+{
+}
+
+ScanStats::~ScanStats()
+{
+    stop_periodic_dump();
+}
+
+ScanCounters& ScanStats::local()
+{
+    if (t_slotCache.owner == m_id) return *t_slotCache.counters;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots.push_back(std::unique_ptr<ScanCounters>(new ScanCounters));
+    t_slotCache.owner = m_id;
+    t_slotCache.counters = m_slots.back().get();
+    return *t_slotCache.counters;
+}
+
+void ScanStats::add_stage_time(const std::string& stage, double seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_stages) {
+        if (entry.first == stage) {
+            entry.second += seconds;
+            return;
+        }
+    }
+    m_stages.emplace_back(stage, seconds);
+}
+
+ScanStatsSnapshot ScanStats::snapshot() const
+{
+    ScanStatsSnapshot snap;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const std::unique_ptr<ScanCounters>& slot : m_slots) {
+        snap.dirs_opened += load(slot->dirs_opened);
+        snap.entries_seen += load(slot->entries_seen);
+        snap.matches += load(slot->matches);
+        snap.syscalls += load(slot->syscalls);
+        snap.bytes_written += load(slot->bytes_written);
+        snap.errors += load(slot->errors);
+        snap.latency_ns += load(slot->latency_ns);
+        for (size_t i = 0; i < kScanLatencyBuckets; ++i) {
+            snap.latency_buckets[i] += load(slot->latency_buckets[i]);
+        }
+    }
+    snap.stages = m_stages;
+    snap.elapsed_seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+    return snap;
+}
+
+void ScanStats::write(std::ostream& out, ScanStatsFormat format) const
+{
+    if (format == ScanStatsFormat::Prometheus) {
+        write_prometheus(out);
+    } else {
+        write_json(out);
+    }
+}
+
+void ScanStats::write_json(std::ostream& out) const
+{
+    const ScanStatsSnapshot snap = snapshot();
+    // 先格式化到字符串再一次写出，定期输出时不会与其他输出交错
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\"elapsed_seconds\":" << snap.elapsed_seconds
+         << ",\"dirs_opened\":" << snap.dirs_opened
+         << ",\"entries_seen\":" << snap.entries_seen
+         << ",\"matches\":" << snap.matches
+         << ",\"syscalls\":" << snap.syscalls
+         << ",\"bytes_written\":" << snap.bytes_written
+         << ",\"errors\":" << snap.errors
+         << ",\"files_per_second\":" << per_second(snap.matches, snap.elapsed_seconds)
+         << ",\"entries_per_second\":" << per_second(snap.entries_seen, snap.elapsed_seconds)
+         << ",\"bytes_per_second\":" << per_second(snap.bytes_written, snap.elapsed_seconds);
+
+    json << ",\"dir_list_latency_us\":{\"buckets\":[";
+    for (size_t i = 0; i < kScanLatencyBuckets; ++i) {
+        if (i > 0) json << ',';
+        json << "{\"le\":";
+        if (bucket_upper_us(i)) {
+            json << bucket_upper_us(i);
+        } else {
+            json << "\"+Inf\"";
+        }
+        json << ",\"count\":" << snap.latency_buckets[i] << '}';
+    }
+    json << "],\"sum_us\":" << snap.latency_ns / 1000 << ",\"count\":" << snap.dirs_opened << '}';
+
+    json << ",\"stages\":{";
+    for (size_t i = 0; i < snap.stages.size(); ++i) {
+        if (i > 0) json << ',';
+        json << '"' << json_escape(snap.stages[i].first) << "\":" << snap.stages[i].second;
+    }
+    json << "}}\n";
+    out << json.str() << std::flush;
+}
+
+void ScanStats::write_prometheus(std::ostream& out) const
+{
+    const ScanStatsSnapshot snap = snapshot();
+    std::ostringstream text;
+    // 直方图上界最大为 4194304us，需要足够的有效位数才能精确输出
+    text << std::setprecision(10);
+
+    const std::pair<const char*, uint64_t> counters[] = {
+        {"animscan_dirs_opened_total", snap.dirs_opened},
+        {"animscan_entries_seen_total", snap.entries_seen},
+        {"animscan_matches_total", snap.matches},
+        {"animscan_syscalls_total", snap.syscalls},
+        {"animscan_bytes_written_total", snap.bytes_written},
+        {"animscan_errors_total", snap.errors},
+    };
+    for (const auto& counter : counters) {
+        text << "# TYPE " << counter.first << " counter\n" << counter.first << ' ' << counter.second << '\n';
+    }
+
+    text << "# TYPE animscan_elapsed_seconds gauge\nanimscan_elapsed_seconds " << snap.elapsed_seconds << '\n';
+    text << "# TYPE animscan_files_per_second gauge\nanimscan_files_per_second "
+         << per_second(snap.matches, snap.elapsed_seconds) << '\n';
+    text << "# TYPE animscan_bytes_per_second gauge\nanimscan_bytes_per_second "
+         << per_second(snap.bytes_written, snap.elapsed_seconds) << '\n';
+
+    // Prometheus 直方图的桶是累计值，上界以秒为单位
+    text << "# TYPE animscan_dir_list_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kScanLatencyBuckets; ++i) {
+        cumulative += snap.latency_buckets[i];
+        text << "animscan_dir_list_seconds_bucket{le=\"";
+        if (bucket_upper_us(i)) {
+            text << bucket_upper_us(i) / 1e6;
+        } else {
+            text << "+Inf";
+        }
+        text << "\"} " << cumulative << '\n';
+    }
+    text << "animscan_dir_list_seconds_sum " << snap.latency_ns / 1e9 << '\n';
+    text << "animscan_dir_list_seconds_count " << cumulative << '\n';
+
+    text << "# TYPE animscan_stage_seconds gauge\n";
+    for (const auto& stage : snap.stages) {
+        text << "animscan_stage_seconds{stage=\"" << stage.first << "\"} " << stage.second << '\n';
+    }
+    out << text.str() << std::flush;
+}
+
+void ScanStats::start_periodic_dump(std::ostream& out, ScanStatsFormat format, unsigned interval_seconds)
+{
+    stop_periodic_dump();
+    if (interval_seconds == 0) return;
+
+    m_dumpStop = false;
+    m_dumpThread = std::thread([this, &out, format, interval_seconds] {
+        std::unique_lock<std::mutex> lock(m_dumpMutex);
+        while (!m_dumpCv.wait_for(lock, std::chrono::seconds(interval_seconds), [this] { return m_dumpStop; })) {
+            write(out, format);
+        }
+    });
+}
+
+void ScanStats::stop_periodic_dump()
+{
+    if (!m_dumpThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_dumpMutex);
+        m_dumpStop = true;
+    }
+    m_dumpCv.notify_all();
+    m_dumpThread.join();
+}
+
+ScanStageTimer::ScanStageTimer(ScanStats* stats, const char* stage)
+    : m_stats(stats), m_stage(stage)
+{
+    if (m_stats) m_start = Clock::now();
+}
+
+ScanStageTimer::~ScanStageTimer()
+{
+    if (m_stats) {
+        m_stats->add_stage_time(m_stage, std::chrono::duration<double>(Clock::now() - m_start).count());
+    }
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 目录列举耗时直方图的桶数：桶 0 为 <1us，桶 i 为 [2^(i-1), 2^i) us，最后一个桶为溢出桶
+const size_t kScanLatencyBuckets = 24;
+
+enum class ScanStatsFormat
+{
+    Json,
+    Prometheus,
+};
+
+// 单个线程的计数器：只由所属线程写入（relaxed 读后写，没有原子读改写指令的开销），
+// 定期输出线程可以并发读取；每个线程一份，按缓存行对齐避免伪共享
+struct alignas(64) ScanCounters
+{
+    std::atomic<uint64_t> dirs_opened{0};
+    std::atomic<uint64_t> entries_seen{0};   // 目录中的全部目录项（不含 . 和 ..）
+    std::atomic<uint64_t> matches{0};        // 匹配的 .anims 文件
+    std::atomic<uint64_t> syscalls{0};       // 仅 getdents64 后端统计（open/getdents64/fstatat/close）
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> latency_ns{0};     // 目录列举总耗时
+    std::atomic<uint64_t> latency_buckets[kScanLatencyBuckets];
+
+    ScanCounters();
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void record_dir_latency(uint64_t nanoseconds);
+};
+
+// 合并后的统计快照
+struct ScanStatsSnapshot
+{
+    uint64_t dirs_opened = 0;
+    uint64_t entries_seen = 0;
+    uint64_t matches = 0;
+    uint64_t syscalls = 0;
+    uint64_t bytes_written = 0;
+    uint64_t errors = 0;
+    uint64_t latency_ns = 0;
+    uint64_t latency_buckets[kScanLatencyBuckets] = {};
+    double elapsed_seconds = 0.0;
+    std::vector<std::pair<std::string, double>> stages;  // 按首次记录的顺序
+};
+
+// 扫描统计：各线程首次调用 local() 时登记自己的计数器，输出时合并所有线程的计数器
+class ScanStats
+{
+public:
+    ScanStats();
+    ~ScanStats();
+
+    ScanStats(const ScanStats&) = delete;
+    ScanStats& operator=(const ScanStats&) = delete;
+
+    // 当前线程的计数器
+    ScanCounters& local();
+
+    // 累加某个阶段的耗时（walk / classify / write 等）
+    void add_stage_time(const std::string& stage, double seconds);
+
+    ScanStatsSnapshot snapshot() const;
+
+    void write(std::ostream& out, ScanStatsFormat format) const;
+    void write_json(std::ostream& out) const;
+    void write_prometheus(std::ostream& out) const;
+
+    // 扫描期间每隔 interval_seconds 秒输出一次当前统计，stop_periodic_dump 或析构时停止
+    void start_periodic_dump(std::ostream& out, ScanStatsFormat format, unsigned interval_seconds);
+    void stop_periodic_dump();
+
+private:
+    const uint64_t m_id;  // 区分不同实例的线程局部缓存（地址可能被复用）
+    const std::chrono::steady_clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ScanCounters>> m_slots;
+    std::vector<std::pair<std::string, double>> m_stages;
+
+    std::thread m_dumpThread;
+    std::mutex m_dumpMutex;
+    std::condition_variable m_dumpCv;
+    bool m_dumpStop = false;
+};
+
+// 作用域计时：析构时把耗时累加到指定阶段；stats 为空时不计时
+class ScanStageTimer
+{
+public:
+    ScanStageTimer(ScanStats* stats, const char* stage);
+    ~ScanStageTimer();
+
+    ScanStageTimer(const ScanStageTimer&) = delete;
+    ScanStageTimer& operator=(const ScanStageTimer&) = delete;
+
+private:
+    ScanStats* m_stats;
+    const char* m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
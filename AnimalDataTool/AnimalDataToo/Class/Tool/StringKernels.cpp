@@ -0,0 +1,246 @@
+﻿#include "StringKernels.h"
+
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define ANIM_KERNELS_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIM_KERNELS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    inline char lower_char(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+#if defined(ANIM_KERNELS_AVX2)
+    // 一个向量块：比较结果压成每字节一位的掩码
+    using Block = __m256i;
+    constexpr size_t kBlockSize = 32;
+
+    inline Block load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    inline void store(char* p, Block v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    inline Block splat(char c) { return _mm256_set1_epi8(c); }
+    inline Block eq(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+    inline Block bit_or(Block a, Block b) { return _mm256_or_si256(a, b); }
+    inline Block bit_and(Block a, Block b) { return _mm256_and_si256(a, b); }
+    inline Block and_not(Block mask, Block v) { return _mm256_andnot_si256(mask, v); }
+    inline Block add(Block a, Block b) { return _mm256_add_epi8(a, b); }
+    inline Block less(Block a, Block b) { return _mm256_cmpgt_epi8(b, a); }  // 有符号比较
+    inline uint32_t mask_of(Block v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+#elif defined(ANIM_KERNELS_SSE2)
+    using Block = __m128i;
+    constexpr size_t kBlockSize = 16;
+
+    inline Block load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    inline void store(char* p, Block v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    inline Block splat(char c) { return _mm_set1_epi8(c); }
+    inline Block eq(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+    inline Block bit_or(Block a, Block b) { return _mm_or_si128(a, b); }
+    inline Block bit_and(Block a, Block b) { return _mm_and_si128(a, b); }
+    inline Block and_not(Block mask, Block v) { return _mm_andnot_si128(mask, v); }
+    inline Block add(Block a, Block b) { return _mm_add_epi8(a, b); }
+    inline Block less(Block a, Block b) { return _mm_cmplt_epi8(a, b); }
+    inline uint32_t mask_of(Block v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+#endif
+
+#if defined(ANIM_KERNELS_AVX2) || defined(ANIM_KERNELS_SSE2)
+#define ANIM_KERNELS_VECTOR 1
+
+    // 不足一个向量的尾部复制到补零的缓冲区里按整块处理（短字段只需一次向量运算），
+    // 比较结果用 tail_bits 去掉补齐部分
+    inline Block load_tail(const char* p, size_t size)
+    {
+        char buffer[kBlockSize] = {};
+        std::memcpy(buffer, p, size);
+        return load(buffer);
+    }
+
+    inline void store_tail(char* p, size_t size, Block v)
+    {
+        char buffer[kBlockSize];
+        store(buffer, v);
+        std::memcpy(p, buffer, size);
+    }
+
+    inline uint32_t tail_bits(size_t size)
+    {
+        return (uint32_t(1) << size) - 1;  // size < kBlockSize <= 32
+    }
+
+    // 'A'..'Z' 加上 128-'A' 后恰好落在有符号的 [-128, -103]，其余字节（包括 >= 0x80 的）都不在这个区间
+    inline Block lower_block(Block v)
+    {
+        const Block shifted = add(v, splat(static_cast<char>(128 - 'A')));
+        const Block upper = less(shifted, splat(static_cast<char>(-128 + 26)));
+        return bit_or(v, bit_and(upper, splat(0x20)));
+    }
+#endif
+
+    // needle 在 text 处是否完整匹配（调用方保证不越界，首尾字节已比较过）
+    inline bool matches_at(const char* text, const std::string_view& needle)
+    {
+        return needle.size() <= 2 || std::memcmp(text + 1, needle.data() + 1, needle.size() - 2) == 0;
+    }
+}
+
+const char* StringKernels::backendName()
+{
+#if defined(ANIM_KERNELS_AVX2)
+    return "avx2";
+#elif defined(ANIM_KERNELS_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void StringKernels::lowerAscii(const char* src, size_t size, char* dst)
+{
+#if defined(ANIM_KERNELS_VECTOR)
+    size_t i = 0;
+    for (; i + kBlockSize <= size; i += kBlockSize) store(dst + i, lower_block(load(src + i)));
+    if (i < size) store_tail(dst + i, size - i, lower_block(load_tail(src + i, size - i)));
+#else
+    for (size_t i = 0; i < size; ++i) dst[i] = lower_char(src[i]);
+#endif
+}
+
+void StringKernels::lowerInto(std::string_view text, std::string& scratch)
+{
+    scratch.resize(text.size());
+    lowerAscii(text.data(), text.size(), &scratch[0]);
+}
+
+size_t StringKernels::find(std::string_view text, std::string_view needle, size_t from)
+{
+    const size_t size = text.size();
+    if (needle.empty()) return from <= size ? from : npos;
+    if (from >= size || needle.size() > size - from) return npos;
+    const char* data = text.data();
+    const size_t last = needle.size() - 1;
+    // 最后一个可能的起点
+    const size_t end = size - needle.size();
+
+    size_t i = from;
+#if defined(ANIM_KERNELS_VECTOR)
+    // 候选位置：首字节和末字节都相同，再 memcmp 确认中间部分（大多数块没有候选）
+    const Block first = splat(needle.front());
+    const Block tail = splat(needle.back());
+    for (; i + kBlockSize <= end + 1; i += kBlockSize) {
+        uint32_t candidates = mask_of(bit_and(eq(load(data + i), first), eq(load(data + i + last), tail)));
+        while (candidates) {
+            const size_t pos = i + lowestBit(candidates);
+            if (matches_at(data + pos, needle)) return pos;
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; i <= end; ++i) {
+        if (data[i] == needle.front() && data[i + last] == needle.back() && matches_at(data + i, needle)) return i;
+    }
+    return npos;
+}
+
+size_t StringKernels::findAnyOf(std::string_view text, std::string_view set)
+{
+    if (set.empty() || set.size() > 16) return text.find_first_of(set);
+    const char* data = text.data();
+    const size_t size = text.size();
+#if defined(ANIM_KERNELS_VECTOR)
+    Block targets[16];
+    for (size_t k = 0; k < set.size(); ++k) targets[k] = splat(set[k]);
+    for (size_t i = 0; i < size; i += kBlockSize) {
+        const size_t remaining = size - i;
+        const Block v = remaining >= kBlockSize ? load(data + i) : load_tail(data + i, remaining);
+        Block hit = eq(v, targets[0]);
+        for (size_t k = 1; k < set.size(); ++k) hit = bit_or(hit, eq(v, targets[k]));
+        uint32_t bits = mask_of(hit);
+        if (remaining < kBlockSize) bits &= tail_bits(remaining);
+        if (bits) return i + lowestBit(bits);
+    }
+#else
+    for (size_t i = 0; i < size; ++i) {
+        if (std::memchr(set.data(), data[i], set.size())) return i;
+    }
+#endif
+    return npos;
+}
+
+size_t StringKernels::countByte(std::string_view text, char byte)
+{
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t count = 0;
+#if defined(ANIM_KERNELS_VECTOR)
+    const Block target = splat(byte);
+    for (size_t i = 0; i < size; i += kBlockSize) {
+        const size_t remaining = size - i;
+        if (remaining >= kBlockSize) {
+            count += std::bitset<32>(mask_of(eq(load(data + i), target))).count();
+        } else {
+            count += std::bitset<32>(mask_of(eq(load_tail(data + i, remaining), target)) & tail_bits(remaining)).count();
+        }
+    }
+#else
+    for (size_t i = 0; i < size; ++i) count += data[i] == byte;
+#endif
+    return count;
+}
+
+void StringKernels::replaceByte(char* data, size_t size, char from, char to)
+{
+#if defined(ANIM_KERNELS_VECTOR)
+    const Block target = splat(from);
+    const Block replacement = splat(to);
+    for (size_t i = 0; i < size; i += kBlockSize) {
+        const size_t remaining = size - i;
+        const Block v = remaining >= kBlockSize ? load(data + i) : load_tail(data + i, remaining);
+        const Block hit = eq(v, target);
+        // 整块都没有命中时不写回
+        if (!mask_of(hit)) continue;
+        const Block replaced = bit_or(and_not(hit, v), bit_and(hit, replacement));
+        if (remaining >= kBlockSize) {
+            store(data + i, replaced);
+        } else {
+            store_tail(data + i, remaining, replaced);
+        }
+    }
+#else
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == from) data[i] = to;
+    }
+#endif
+}
+
+void StringKernels::byteMasks64(const char* data, size_t size, std::string_view bytes, uint64_t* masks)
+{
+    const size_t count = bytes.size() < 4 ? bytes.size() : 4;
+    const size_t block = size < 64 ? size : 64;
+    for (size_t k = 0; k < count; ++k) masks[k] = 0;
+#if defined(ANIM_KERNELS_VECTOR)
+    Block targets[4];
+    for (size_t k = 0; k < count; ++k) targets[k] = splat(bytes[k]);
+    for (size_t i = 0; i < block; i += kBlockSize) {
+        const size_t remaining = block - i;
+        const Block v = remaining >= kBlockSize ? load(data + i) : load_tail(data + i, remaining);
+        for (size_t k = 0; k < count; ++k) {
+            uint32_t bits = mask_of(eq(v, targets[k]));
+            if (remaining < kBlockSize) bits &= tail_bits(remaining);
+            masks[k] |= static_cast<uint64_t>(bits) << i;
+        }
+    }
+#else
+    for (size_t i = 0; i < block; ++i) {
+        for (size_t k = 0; k < count; ++k) {
+            if (data[i] == bytes[k]) masks[k] |= uint64_t(1) << i;
+        }
+    }
+#endif
+}
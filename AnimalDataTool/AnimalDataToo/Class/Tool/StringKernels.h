@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 路径分类用的字符串内核：一次处理一个向量宽度的字节（AVX2 32 字节 / SSE2 16 字节），
+// 不足一个向量的尾部和不支持 SIMD 的平台走标量实现，结果完全相同。
+// 实现在编译期选择：定义了 __AVX2__（MSVC /arch:AVX2，GCC -mavx2）时用 AVX2，x64 默认 SSE2
+class StringKernels
+{
+public:
+    static constexpr size_t npos = std::string_view::npos;
+
+    // 最低置位的序号（bits 不能为 0）；32 位 MSVC 没有 _BitScanForward64，分低、高两半查找
+    static unsigned lowestBit(uint64_t bits)
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (static_cast<uint32_t>(bits) != 0) {
+            _BitScanForward(&index, static_cast<uint32_t>(bits));
+            return static_cast<unsigned>(index);
+        }
+        _BitScanForward(&index, static_cast<uint32_t>(bits >> 32));
+        return static_cast<unsigned>(index) + 32;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+    }
+
+    // 规则关键字的 \b 边界判断用的单词字符：ASCII 字母、数字和下划线
+    static bool isWordChar(unsigned char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // 当前编译使用的实现："avx2"、"sse2" 或 "scalar"
+    static const char* backendName();
+
+    // ASCII 大写字母转小写，其余字节不变；dst 可以等于 src
+    static void lowerAscii(const char* src, size_t size, char* dst);
+    // 把 text 的小写形式写入 scratch（复用其容量，容量足够时不分配）
+    static void lowerInto(std::string_view text, std::string& scratch);
+
+    // from 之后第一次出现 needle 的位置，没有时返回 npos（同 std::string_view::find）
+    static size_t find(std::string_view text, std::string_view needle, size_t from = 0);
+    // 第一个属于 set 的字节（set 最多 16 个字节）
+    static size_t findAnyOf(std::string_view text, std::string_view set);
+
+    static size_t countByte(std::string_view text, char byte);
+    static void replaceByte(char* data, size_t size, char from, char to);
+
+    // data 的前 min(size, 64) 个字节中等于 bytes[k] 的位置写成 masks[k] 的位图（第 i 位对应 data[i]，
+    // 超出 size 的位为 0）；bytes 最多 4 个字节。CsvReader 用它逐块找引号和分隔符
+    static void byteMasks64(const char* data, size_t size, std::string_view bytes, uint64_t* masks);
+};
@@ -0,0 +1,153 @@
+﻿#include "WorkStealingPool.h"
+
+namespace
+{
+    // 记录当前线程属于哪个线程池以及在池中的下标
+    struct WorkerIdentity
+    {
+        const WorkStealingPool* pool = nullptr;
+        int index = -1;
+    };
+    thread_local WorkerIdentity t_identity;
+}
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+{
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+        if (thread_count == 0) thread_count = 1;
+    }
+
+    m_workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    // 队列全部建好后再启动线程，避免窃取时访问未构造的队列
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_workers[i]->thread = std::thread(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_sleepCv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+int WorkStealingPool::worker_index() const
+{
+    return t_identity.pool == this ? t_identity.index : -1;
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    int self = worker_index();
+    size_t target = self >= 0
+        ? static_cast<size_t>(self)
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    m_pending.fetch_add(1, std::memory_order_acq_rel);
+    {
+        // 在睡眠锁内递增计数，保证等待线程不会错过唤醒
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_queued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_workers[target]->mutex);
+        m_workers[target]->queue.push_back(std::move(task));
+    }
+    m_sleepCv.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_doneMutex);
+        m_doneCv.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        error = m_firstError;
+        m_firstError = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::pop_local(size_t index, Task& task)
+{
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.queue.empty()) return false;
+    task = std::move(worker.queue.back());
+    worker.queue.pop_back();
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Task& task)
+{
+    const size_t count = m_workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            task = std::move(victim.queue.front());
+            victim.queue.pop_front();
+            m_queued.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run_task(Task& task)
+{
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        if (!m_firstError) {
+            m_firstError = std::current_exception();
+        }
+    }
+    task = nullptr;
+
+    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(m_doneMutex);
+        m_doneCv.notify_all();
+    }
+}
+
+void WorkStealingPool::worker_loop(size_t index)
+{
+    t_identity.pool = this;
+    t_identity.index = static_cast<int>(index);
+
+    Task task;
+    while (true) {
+        if (pop_local(index, task) || steal(index, task)) {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCv.wait(lock, [this] {
+            return m_stop.load() || m_queued.load(std::memory_order_acquire) > 0;
+        });
+        if (m_stop.load() && m_queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程持有自己的任务队列，
+// 本线程从队尾取（LIFO，保持局部性），空闲线程从其他队列队首窃取（FIFO）。
+// 任务内部可以继续 submit 子任务（例如目录遍历时每个子目录一个任务）。
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // thread_count 为 0 时使用 std::thread::hardware_concurrency()
+    explicit WorkStealingPool(size_t thread_count = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // 提交任务：工作线程内提交时压入自己的队列，外部提交时轮询分发
+    void submit(Task task);
+
+    // 阻塞直到所有已提交任务（包括任务中派生的子任务）执行完毕；
+    // 若有任务抛出异常，在此重新抛出第一个异常
+    void wait();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+    // 当前线程在本线程池中的下标，非工作线程返回 -1
+    int worker_index() const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> queue;
+        std::thread thread;
+    };
+
+    void worker_loop(size_t index);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void run_task(Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_queued{0};     // 尚在队列中的任务数
+    std::atomic<size_t> m_pending{0};    // 已提交但未执行完的任务数
+    std::atomic<size_t> m_nextQueue{0};  // 外部提交的轮询下标
+    std::atomic<bool> m_stop{false};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCv;
+    std::mutex m_doneMutex;
+    std::condition_variable m_doneCv;
+
+    std::mutex m_errorMutex;
+    std::exception_ptr m_firstError;
+};
@@ -1,8 +1,45 @@
 ﻿#include "WriteTool.h"
 
-#include <fstream>
 #include <iostream>
+#include <sstream>
 
+#include "AnimGroup.h"
+#include "AnimMetadata.h"
+#include "CompactRow.h"
+#include "ContentHasher.h"
+#include "CsvWriter.h"
+#include "PathTable.h"
+
+
+namespace
+{
+    bool open_csv(CsvWriter& csv_file, const std::string& csv_path)
+    {
+        if (!csv_file.open(csv_path)) {
+            std::cerr << "错误：无法创建/打开 CSV 文件 -> " << csv_path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 等待剩余数据写盘；写入失败时 close 已输出错误
+    bool finish_csv(CsvWriter& csv_file, const std::string& csv_path)
+    {
+        if (!csv_file.close()) return false;
+        std::cout << "CSV 文件已成功生成：" << csv_path << std::endl;
+        return true;
+    }
+
+    // 序号,"文件名称","完整路径"
+    void append_file_columns(std::string& out, size_t number, std::string_view full_path)
+    {
+        CsvWriter::append_uint(out, number);
+        out.push_back(',');
+        CsvWriter::append_quoted(out, PathTable::file_name_of(full_path));
+        out.push_back(',');
+        CsvWriter::append_quoted(out, full_path);
+    }
+}
 
 WriteTool::WriteTool()
 {
@@ -11,32 +48,229 @@ WriteTool::WriteTool()
 
 // 核心功能：将文件列表写入 CSV 文件（Excel 可直接打开）
 bool WriteTool::write_to_csv(const std::vector<std::string>& files, const std::string& csv_path) {
-    // 创建文件输出流（std::ofstream），指定路径和打开模式
-    std::ofstream csv_file(csv_path, std::ios::out | std::ios::trunc);
-    if (!csv_file.is_open()) {  // 检查文件是否成功打开
-        std::cerr << "错误：无法创建/打开 CSV 文件 -> " << csv_path << std::endl;
+    // 行先格式化到大缓冲区，由后台线程批量写盘
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {  // 检查文件是否成功打开
         return false;
     }
 
     // 1. 写入 CSV 表头（第一行：序号、文件名称、完整路径）
-    csv_file << "序号,文件名称,完整路径" << std::endl;  // CSV 用逗号分隔列
-
-    // 2. 写入文件列表数据
-    for (size_t i = 0; i < files.size(); ++i) {
-        fs::path file_path(files[i]);
-        std::string filename = file_path.filename().string();  // 文件名（含后缀）
-        std::string full_path = file_path.string();            // 完整路径
-
-        // CSV 规则：若内容含逗号/引号，需用双引号包裹（避免列错乱）
-        // 简化处理：直接给文件名和路径加双引号（兼容所有情况）
-        csv_file << (i + 1)  // 序号（从 1 开始）
-                 << "," << "\"" << filename << "\""  // 文件名（双引号包裹）
-                 << "," << "\"" << full_path << "\""  // 完整路径（双引号包裹）
-                 << std::endl;  // 换行
-    }
-
-    // 3. 关闭文件流（自动刷新数据）
-    csv_file.close();
-    std::cout << "CSV 文件已成功生成：" << csv_path << std::endl;
-    return true;
-}
\ No newline at end of file
+    csv_file.append("序号,文件名称,完整路径\n");  // CSV 用逗号分隔列
+
+    // 2. 写入文件列表数据（分块并行格式化，按顺序写出）
+    // CSV 规则：若内容含逗号/引号，需用双引号包裹（避免列错乱）
+    // 简化处理：直接给文件名和路径加双引号（兼容所有情况）；文件名直接从路径中截取
+    csv_file.append_rows(files.size(), [&files](size_t begin, size_t end, std::string& out) {
+        for (size_t i = begin; i < end; ++i) {
+            append_file_columns(out, i + 1, files[i]);  // 序号（从 1 开始）、文件名、完整路径
+            out.push_back('\n');
+        }
+    });
+
+    // 3. 关闭文件（写出剩余数据）
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_to_csv(const PathTable& table, const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append("序号,文件名称,完整路径\n");
+
+    // 每块复用同一块缓冲区拼接完整路径，文件名直接取自路径表
+    csv_file.append_rows(table.file_count(), [&table](size_t begin, size_t end, std::string& out) {
+        std::string full_path;
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t file = static_cast<uint32_t>(i);
+            full_path.clear();
+            table.append_full_path(file, full_path);
+            CsvWriter::append_uint(out, i + 1);
+            out.push_back(',');
+            CsvWriter::append_quoted(out, table.file_name(file));
+            out.push_back(',');
+            CsvWriter::append_quoted(out, full_path);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_classified_csv(const std::vector<CSVRow>& rows, const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append(kClassifiedCSVHeader);
+    csv_file.end_row();
+    csv_file.append_rows(rows.size(), [&rows](size_t begin, size_t end, std::string& out) {
+        for (size_t i = begin; i < end; ++i) {
+            appendClassifiedFields(out, rows[i]);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_classified_csv(const CompactRowTable& table, const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append(kClassifiedCSVHeader);
+    csv_file.end_row();
+    csv_file.append_rows(table.size(), [&table](size_t begin, size_t end, std::string& out) {
+        CSVRow row;
+        for (size_t i = begin; i < end; ++i) {
+            table.materialize(i, row);
+            appendClassifiedFields(out, row);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_classified_csv(const CompactRowTable& table, const std::vector<uint32_t>& group_ids,
+                                     const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append(kClassifiedCSVHeader);
+    csv_file.append(",group_id\n");
+    csv_file.append_rows(table.size(), [&table, &group_ids](size_t begin, size_t end, std::string& out) {
+        CSVRow row;
+        for (size_t i = begin; i < end; ++i) {
+            table.materialize(i, row);
+            appendClassifiedFields(out, row);
+            out.push_back(',');
+            CsvWriter::append_uint(out, group_ids[i]);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_reclassify_diff(const std::vector<CSVRow>& rows, const std::vector<std::string>& changes,
+                                      const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append(kClassifiedCSVHeader);
+    csv_file.append(",变化\n");
+    csv_file.append_rows(rows.size(), [&rows, &changes](size_t begin, size_t end, std::string& out) {
+        for (size_t i = begin; i < end; ++i) {
+            appendClassifiedFields(out, rows[i]);
+            out.push_back(',');
+            appendEscapedCSV(out, changes[i]);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_to_csv(const std::vector<std::string>& files, const ContentHasher& hasher,
+                             const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append("序号,文件名称,完整路径,content_hash\n");
+    csv_file.append_rows(files.size(), [&files, &hasher](size_t begin, size_t end, std::string& out) {
+        for (size_t i = begin; i < end; ++i) {
+            // 大小唯一的文件没有计算哈希，该列留空
+            append_file_columns(out, i + 1, files[i]);
+            out.push_back(',');
+            out += hasher.hash_hex(i);
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_metadata_csv(const std::vector<std::string>& files, const std::vector<AnimFileMetadata>& metadata,
+                                   const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append("序号,文件名称,完整路径,动画数量,骨骼,动画名称,动画时长\n");
+    csv_file.append_rows(files.size(), [&files, &metadata](size_t begin, size_t end, std::string& out) {
+        std::string names;
+        std::ostringstream durations;
+        durations.precision(3);
+        durations << std::fixed;
+        for (size_t i = begin; i < end; ++i) {
+            append_file_columns(out, i + 1, files[i]);
+
+            // 无法解析的文件元数据列留空
+            const AnimFileMetadata& meta = metadata[i];
+            if (!meta.valid) {
+                out += ",,,,\n";
+                continue;
+            }
+            names.clear();
+            durations.str(std::string());
+            for (size_t a = 0; a < meta.animations.size(); ++a) {
+                if (a > 0) {
+                    names += "; ";
+                    durations << "; ";
+                }
+                names += meta.animations[a].name;
+                durations << meta.animations[a].duration;
+            }
+            out.push_back(',');
+            CsvWriter::append_uint(out, meta.animation_count);
+            out.push_back(',');
+            appendEscapedCSV(out, meta.rig_path);
+            out.push_back(',');
+            appendEscapedCSV(out, names);
+            out.push_back(',');
+            appendEscapedCSV(out, durations.str());
+            out.push_back('\n');
+        }
+    });
+
+    return finish_csv(csv_file, csv_path);
+}
+
+bool WriteTool::write_duplicate_groups(const std::vector<std::string>& files, const ContentHasher& hasher,
+                                       const std::string& csv_path) {
+    CsvWriter csv_file;
+    if (!open_csv(csv_file, csv_path)) {
+        return false;
+    }
+
+    csv_file.append("分组,文件数,文件大小,content_hash,完整路径\n");
+    const std::vector<std::vector<size_t>>& groups = hasher.duplicate_groups();
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (size_t index : groups[g]) {
+            csv_file.append_uint(g + 1);
+            csv_file.append(',');
+            csv_file.append_uint(groups[g].size());
+            csv_file.append(',');
+            csv_file.append_uint(hasher.file_size(index));
+            csv_file.append(',');
+            csv_file.append(hasher.hash_hex(index));
+            csv_file.append(',');
+            csv_file.append_quoted(files[index]);
+            csv_file.end_row();
+        }
+    }
+
+    return finish_csv(csv_file, csv_path);
+}
@@ -1,11 +1,41 @@
 ﻿#pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <filesystem>  // C++17 原生文件系统库
 namespace fs = std::filesystem;  // 简化命名空间
+
+struct AnimFileMetadata;
+struct CSVRow;
+class CompactRowTable;
+class ContentHasher;
+class PathTable;
+
 class WriteTool
 {
 public:
     WriteTool();
     bool write_to_csv(const std::vector<std::string>& files, const std::string& csv_path);
+    // 从路径表写出，输出内容与 vector<string> 版本相同，完整路径只在写出时拼接
+    bool write_to_csv(const PathTable& table, const std::string& csv_path);
+    // 写出带分类列的 CSV（表头见 kClassifiedCSVHeader）
+    bool write_classified_csv(const std::vector<CSVRow>& rows, const std::string& csv_path);
+    // 从紧凑分类表写出，输出内容与 CSVRow 版本相同，每行的字符串在写出时才生成
+    bool write_classified_csv(const CompactRowTable& table, const std::string& csv_path);
+    // 在分类列之后追加 group_id 列（AnimNameClusterer 的分组编号，与表中的行一一对应）
+    bool write_classified_csv(const CompactRowTable& table, const std::vector<uint32_t>& group_ids,
+                              const std::string& csv_path);
+    // 重新分类的差异报告：分类列为当前规则的结果，最后的 变化 列为 "列名: 旧值 -> 新值"（多列以 "; " 分隔），
+    // changes 与 rows 一一对应
+    bool write_reclassify_diff(const std::vector<CSVRow>& rows, const std::vector<std::string>& changes,
+                               const std::string& csv_path);
+    // 在 序号,文件名称,完整路径 之后追加 content_hash 列（hasher 的结果与 files 一一对应）
+    bool write_to_csv(const std::vector<std::string>& files, const ContentHasher& hasher,
+                      const std::string& csv_path);
+    // 在 序号,文件名称,完整路径 之后追加文件头元数据列：动画数量、骨骼、动画名称、动画时长（多个动画以 "; " 分隔）
+    bool write_metadata_csv(const std::vector<std::string>& files, const std::vector<AnimFileMetadata>& metadata,
+                            const std::string& csv_path);
+    // 写出重复分组报告：每行一个文件，同组文件的分组编号相同
+    bool write_duplicate_groups(const std::vector<std::string>& files, const ContentHasher& hasher,
+                                const std::string& csv_path);
 };